@@ -26,6 +26,15 @@
 #include "SceneManagement.h"
 #include "DynamicMeshBuilder.h"
 #include "StaticMeshResources.h"
+#include "Misc/Paths.h"
+#include "Async/Async.h"
+#include "Serialization/MemoryWriter.h"
+#include "XkGamedevCore.h"
+#include "XkHexagon/XkHexagonGenerateJob.h"
+#include "XkHexagon/XkHexagonActorPool.h"
+#include "XkCamera.h"
+#include "GameFramework/PlayerController.h"
+#include "Camera/PlayerCameraManager.h"
 
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(XkGameWorld)
@@ -51,6 +60,16 @@ AXkSphericalWorldWithOceanActor::AXkSphericalWorldWithOceanActor(const FObjectIn
 	bShowSpawnedActorBaseMesh = true;
 	bShowSpawnedActorEdgeMesh = true;
 	PositionRandomRange = FVector2D(0.0, 0.0);
+	WorldSeed = 0;
+	HeightNoiseSize = 0.0f;
+	bUseGenerateCache = true;
+#if WITH_EDITOR
+	bHexagonActorsRefreshPending = false;
+#endif
+	bStreamChunks = false;
+	ChunkLoadRadius = 2;
+	ChunkUnloadRadius = 3;
+	MaxAppliedChunksPerFrame = 4;
 
 	// Activate ticking in order to update the cursor every frame.
 	PrimaryActorTick.bCanEverTick = true;
@@ -58,31 +77,124 @@ AXkSphericalWorldWithOceanActor::AXkSphericalWorldWithOceanActor(const FObjectIn
 }
 
 
-void AXkSphericalWorldWithOceanActor::TickActor(float DeltaTime, ELevelTick TickType, FActorTickFunction& ThisTickFunction)
+void AXkSphericalWorldWithOceanActor::BeginPlay()
 {
-	Super::TickActor(DeltaTime, TickType, ThisTickFunction);
+	Super::BeginPlay();
+
+	UXkHexagonActorPoolSubsystem* HexagonActorPool = UXkHexagonActorPoolSubsystem::Get(GetWorld());
+	if (bSpawnActors && HexagonActorPool)
+	{
+		HexagonActorPool->SetMaxFreeActorNum(this, GetSpawnActorNum());
+		HexagonActorPool->Prewarm(GetSpawnActorNum());
+	}
 }
 
 
-void AXkSphericalWorldWithOceanActor::OnConstruction(const FTransform& Transform)
+void AXkSphericalWorldWithOceanActor::TickActor(float DeltaTime, ELevelTick TickType, FActorTickFunction& ThisTickFunction)
 {
-	Super::OnConstruction(Transform);
+	if (RegenerateJob.IsReady())
+	{
+		ApplyRegenerateResult();
+	}
 #if WITH_EDITOR
-	// update all HexagonActor settings for hexagonal world
-	for (TActorIterator<AXkHexagonActor> It(GetWorld()); It; ++It)
+	if (bHexagonActorsRefreshPending)
+	{
+		FlushHexagonActorsRefresh();
+	}
+#endif
+	if (ChunkStreamer.IsStreaming())
 	{
-		AXkHexagonActor* HexagonActor = *It;
-		if (IsValid(HexagonActor))
+		const FVector Center = GetStreamingCenter() - GetActorLocation();
+		const FIntVector CenterCoord = FXkHexagonAStarPathfinding::CalcHexagonCoord(Center.X, Center.Y, Radius + GapWidth);
+		TArray<FIntPoint> ChangedChunks;
+		if (ChunkStreamer.Update(CenterCoord, ChunkLoadRadius, ChunkUnloadRadius, MaxAppliedChunksPerFrame, &ChangedChunks) > 0)
 		{
-			HexagonActor->SetHexagonWorld(this);
-			HexagonActor->ConstructionScripts();
+			DrawChunkCanvas(ChangedChunks);
 		}
 	}
+	// Super publishes the node table snapshot, after the streamed chunks are applied.
+	Super::TickActor(DeltaTime, TickType, ThisTickFunction);
+}
+
+
+bool AXkSphericalWorldWithOceanActor::ShouldTickIfViewportsOnly() const
+{
+	// Editor worlds only tick to apply a finished regeneration or the pending actor refresh.
+#if WITH_EDITOR
+	if (bHexagonActorsRefreshPending)
+	{
+		return true;
+	}
+#endif
+	return RegenerateJob.IsRunning() || RegenerateJob.IsReady();
+}
+
+
+void AXkSphericalWorldWithOceanActor::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	RegenerateJob.Cancel();
+	ChunkStreamer.Shutdown();
+	if (UXkHexagonActorPoolSubsystem* HexagonActorPool = UXkHexagonActorPoolSubsystem::Get(GetWorld()))
+	{
+		HexagonActorPool->ClearMaxFreeActorNum(this);
+	}
+	Super::EndPlay(EndPlayReason);
+}
+
+
+void AXkSphericalWorldWithOceanActor::OnConstruction(const FTransform& Transform)
+{
+	Super::OnConstruction(Transform);
+#if WITH_EDITOR
+	// Dragging a property runs construction every change, the actors are refreshed once in the next tick.
+	bHexagonActorsRefreshPending = true;
 #endif
 	CanvasRendererComponent->SplatMaskRange = HexagonSplatMaskRange;
 }
 
 
+#if WITH_EDITOR
+void AXkSphericalWorldWithOceanActor::FlushHexagonActorsRefresh()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(AXkSphericalWorldWithOceanActor::FlushHexagonActorsRefresh);
+
+	bHexagonActorsRefreshPending = false;
+	if (!GetWorld())
+	{
+		return;
+	}
+	// Only the indexed actors of this world, the free actors of the pool are not touched.
+	// Actors skip the colors and geometry they already applied, unchanged properties touch nothing.
+	for (AXkHexagonActor* HexagonActor : GetHexagonActors())
+	{
+		HexagonActor->RefreshHexagon();
+	}
+}
+
+
+void AXkSphericalWorldWithOceanActor::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	static const TSet<FName> GenerateProperties = {
+		GET_MEMBER_NAME_CHECKED(AXkSphericalWorldWithOceanActor, Radius),
+		GET_MEMBER_NAME_CHECKED(AXkSphericalWorldWithOceanActor, GapWidth),
+		GET_MEMBER_NAME_CHECKED(AXkSphericalWorldWithOceanActor, GroundManhattanDistance),
+		GET_MEMBER_NAME_CHECKED(AXkSphericalWorldWithOceanActor, ShorelineManhattanDistance),
+		GET_MEMBER_NAME_CHECKED(AXkSphericalWorldWithOceanActor, WorldSeed),
+		GET_MEMBER_NAME_CHECKED(AXkSphericalWorldWithOceanActor, HexagonSplats),
+		GET_MEMBER_NAME_CHECKED(AXkSphericalWorldWithOceanActor, HeightNoiseSize),
+	};
+	// Only the changed stages and rings are generated again when the layout is kept, otherwise dragging
+	// a value restarts the async job every change and the cancelled ones never reach the world.
+	if (GenerateProperties.Contains(PropertyChangedEvent.GetMemberPropertyName()) && GetWorld())
+	{
+		UpdateWorld();
+	}
+}
+#endif
+
+
 void AXkSphericalWorldWithOceanActor::GenerateHexagons()
 {
 	TRACE_CPUPROFILER_EVENT_SCOPE(AXkSphericalWorldWithOceanActor::GenerateHexagons);
@@ -92,139 +204,551 @@ void AXkSphericalWorldWithOceanActor::GenerateHexagons()
 		return;
 	}
 
-	for (TActorIterator<AXkHexagonActor> It(GetWorld()); It; ++It)
+	RegenerateJob.Cancel();
+	ReleaseHexagonActors();
+
+	// Only the layout here, GenerateHexagonalWorld runs the remaining stages on the same grid.
+	const FXkHexagonalWorldGenerator Generator(MakeGenerateSettings());
+	LastGenerateStats = FXkHexagonGenerateStats();
+	Generator.Generate(HexagonalWorldGrid, &LastGenerateStats, EXkHexagonGenerateStage::Layout, EXkHexagonGenerateStage::Layout);
+	Generator.RunStage(EXkHexagonGenerateStage::PostProcess, HexagonalWorldGrid);
+	HexagonalWorldGrid.FillNodes(ModifyHexagonalWorldNodes());
+	MarkHexagonalWorldDirty();
+	ResizeHexagonInfluenceMap(HexagonalWorldGrid.MaxManhattanDistance);
+
+	SpawnHexagonActors();
+}
+
+
+void AXkSphericalWorldWithOceanActor::GenerateHexagonalWorld()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(AXkSphericalWorldWithOceanActor::GenerateHexagonalWorld);
+
+	if (!GetWorld())
+	{
+		return;
+	}
+
+	const FXkHexagonalWorldGenerateSettings Settings = MakeGenerateSettings();
+	const FXkHexagonalWorldGenerator Generator(Settings);
+	// The grid is laid out by GenerateHexagons, lay it out again when the world size changed since.
+	if (HexagonalWorldGrid.Pitch == 0 || HexagonalWorldGrid.MaxManhattanDistance != Settings.GetMaxManhattanDistance())
+	{
+		Generator.Generate(HexagonalWorldGrid, &LastGenerateStats, EXkHexagonGenerateStage::Layout, EXkHexagonGenerateStage::Layout);
+	}
+	Generator.Generate(HexagonalWorldGrid, &LastGenerateStats, EXkHexagonGenerateStage::Classification, EXkHexagonGenerateStage::PostProcess);
+	HexagonalWorldGrid.FillNodes(ModifyHexagonalWorldNodes());
+	MarkHexagonalWorldDirty();
+	ResizeHexagonInfluenceMap(HexagonalWorldGrid.MaxManhattanDistance);
+
+	UE_LOG(LogXkGamedevCore, Verbose, TEXT("%s generated %d hexagons, %s %.3fms, %s %.3fms, %s %.3fms, %s %.3fms"), *GetName(), LastGenerateStats.NodeNum,
+		FXkHexagonalWorldGenerator::GetStageName(EXkHexagonGenerateStage::Layout), LastGenerateStats.StageSeconds[(int32)EXkHexagonGenerateStage::Layout] * 1000.0,
+		FXkHexagonalWorldGenerator::GetStageName(EXkHexagonGenerateStage::Classification), LastGenerateStats.StageSeconds[(int32)EXkHexagonGenerateStage::Classification] * 1000.0,
+		FXkHexagonalWorldGenerator::GetStageName(EXkHexagonGenerateStage::HeightSplat), LastGenerateStats.StageSeconds[(int32)EXkHexagonGenerateStage::HeightSplat] * 1000.0,
+		FXkHexagonalWorldGenerator::GetStageName(EXkHexagonGenerateStage::PostProcess), LastGenerateStats.StageSeconds[(int32)EXkHexagonGenerateStage::PostProcess] * 1000.0);
+}
+
+
+void AXkSphericalWorldWithOceanActor::GenerateCanvas()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(AXkSphericalWorldWithOceanActor::GenerateCanvas);
+
+	// get instance
+	TArray<FVector4f> InstancePositionData;
+	TArray<FVector4f> InstanceWeightData;
+	FXkHexagonalWorldGenerateJob::BuildCanvasInstances(ModifyHexagonalWorldNodes(), InstancePositionData, InstanceWeightData);
+	DrawCanvasInstances(InstancePositionData, InstanceWeightData);
+}
+
+
+void AXkSphericalWorldWithOceanActor::DrawCanvasInstances(const TArray<FVector4f>& InstancePositionData, const TArray<FVector4f>& InstanceWeightData, const FBox2D* InDirtyBounds)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(AXkSphericalWorldWithOceanActor::DrawCanvasInstances);
+
+	// get vertex, shared with every other user of the same hexagon sizes
+	const FXkHexagonGeometryPtr Geometry = FXkHexagonGeometryCache::Get(GetHexagonGeometryKey());
+
+	const FVector2D FullUnscaledWorldSize = GetCanvasWorldSize();
+	FVector4f CanvasExtent = CanvasRendererComponent->GetCanvasExtent();
+	// The rest of the canvas is only valid while the extent stays the same.
+	const bool bDrawDirtyBounds = InDirtyBounds && CanvasExtent.X == FullUnscaledWorldSize.X && CanvasExtent.Y == FullUnscaledWorldSize.Y;
+	CanvasExtent.X = FullUnscaledWorldSize.X;
+	CanvasExtent.Y = FullUnscaledWorldSize.Y;
+	CanvasRendererComponent->SetCanvasExtent(CanvasExtent);
+	CanvasRendererComponent->CreateBuffers(Geometry->GetBaseVertices(), Geometry->GetBaseIndices(), InstancePositionData, InstanceWeightData);
+	if (bDrawDirtyBounds)
 	{
-		AXkHexagonActor* HexagonActor = *It;
-		HexagonActor->Destroy();
+		CanvasRendererComponent->DrawCanvas(*InDirtyBounds);
 	}
+	else
+	{
+		CanvasRendererComponent->DrawCanvas();
+	}
+}
 
-	ModifyHexagonalWorldNodes().Empty();
 
-	for (int32 X = -MaxManhattanDistance; X < (MaxManhattanDistance + 1); X++)
+void AXkSphericalWorldWithOceanActor::DrawChunkCanvas(const TArray<FIntPoint>& InChunkKeys)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(AXkSphericalWorldWithOceanActor::DrawChunkCanvas);
+
+	const FBox2D DirtyBounds = GetChunkCanvasBounds(InChunkKeys);
+	const FVector4f CanvasExtent = CanvasRendererComponent->GetCanvasExtent();
+	const FVector2D FullUnscaledWorldSize = GetCanvasWorldSize();
+	TArray<FVector4f> InstancePositionData;
+	TArray<FVector4f> InstanceWeightData;
+	if (CanvasExtent.X == FullUnscaledWorldSize.X && CanvasExtent.Y == FullUnscaledWorldSize.Y)
 	{
-		for (int32 Y = -MaxManhattanDistance; Y < (MaxManhattanDistance + 1); Y++)
+		// Only the hexagons reaching into the redrawn pixels are uploaded, the rect already holds the filter margin
+		// and the height filter draws the instances around it as well.
+		FIntRect DirtyRect = CanvasRendererComponent->GetCanvasDirtyRect(DirtyBounds);
+		DirtyRect.InflateRect(CanvasRendererComponent->GetHeightFilterRange());
+		const FBox2D InstanceBounds = CanvasRendererComponent->GetCanvasRectBounds(DirtyRect).ExpandBy(Radius + GapWidth);
+		FXkHexagonalWorldGenerateJob::BuildCanvasInstances(ModifyHexagonalWorldNodes(), InstancePositionData, InstanceWeightData, &InstanceBounds);
+	}
+	// A new extent draws the whole canvas again, and the rect of unloaded chunks is only cleared by a draw with instances.
+	if (InstancePositionData.Num() == 0)
+	{
+		FXkHexagonalWorldGenerateJob::BuildCanvasInstances(ModifyHexagonalWorldNodes(), InstancePositionData, InstanceWeightData);
+	}
+	DrawCanvasInstances(InstancePositionData, InstanceWeightData, &DirtyBounds);
+}
+
+
+FVector2D AXkSphericalWorldWithOceanActor::GetCanvasWorldSize() const
+{
+	const FVector2D Resolution = CanvasRendererComponent->GetCanvasSize();
+	const FVector2D HexagonalWorldExtent = GetHexagonalWorldExtent();
+	const FVector2D UnscaledPatchCoverage = FVector2D(FMath::Max(HexagonalWorldExtent.X, HexagonalWorldExtent.Y) * 2.0);
+	return GetFullUnscaledWorldSize(UnscaledPatchCoverage, Resolution);
+}
+
+
+FBox2D AXkSphericalWorldWithOceanActor::GetChunkCanvasBounds(const TArray<FIntPoint>& InChunkKeys) const
+{
+	// Positions are linear in the coord, the corner coords of a chunk bound all of its hexagons.
+	const float Distance = Radius + GapWidth;
+	auto GetCoordPosition = [Distance](const int32 X, const int32 Y)
 		{
-			float Dist = Radius + GapWidth;
-			FVector2D Pos = FXkHexagonAStarPathfinding::CalcHexagonPosition(X, Y, Dist);
-			//////////////////////////////////////////////////////////////
-			// calculate XkHexagon coordinate
-			FIntVector HexagonCoord = FXkHexagonAStarPathfinding::CalcHexagonCoord(Pos.X, Pos.Y, Dist);
-			int32 ManhattanDistanceToCenter = FXkHexagonAStarPathfinding::CalcManhattanDistance(HexagonCoord, FIntVector(0, 0, 0));
-			FVector4f Position = FVector4f(Pos.X, Pos.Y, 0.0, Radius);
-
-			FXkHexagonNode HexagonNode = FXkHexagonNode(EXkHexagonType::Ocean | EXkHexagonType::Unavailable, Position, 0, HexagonCoord);
-			if (ManhattanDistanceToCenter < (GroundManhattanDistance + ShorelineManhattanDistance))
-			{
-				ModifyHexagonalWorldNodes().Add(HexagonCoord, HexagonNode);
-				if (bSpawnActors && ManhattanDistanceToCenter < SpawnActorsMaxMhtDist)
-				{
-					FActorSpawnParameters ActorSpawnParameters;
-					FVector Location = FVector(Position.X, Position.Y, Position.Z + 200.0);
-					AXkHexagonActor* HexagonActor = GetWorld()->SpawnActor<AXkHexagonActor>(AXkHexagonActor::StaticClass(), Location, FRotator(0.0), ActorSpawnParameters);
-					HexagonActor->SetFlags(RF_Transient);
-					HexagonActor->SetCoord(HexagonCoord);
-					HexagonActor->SetHexagonWorld(this);
-#if WITH_EDITOR
-					FString CoordString = FString::Printf(
-						TEXT("HexagonActor(%i, %i, %i)"), HexagonCoord.X, HexagonCoord.Y, HexagonCoord.Z);
-					HexagonActor->SetActorLabel(CoordString);
-#endif
-					HexagonActor->ConstructionScripts();
-					HexagonActor->AttachToActor(this, FAttachmentTransformRules::KeepRelativeTransform);
-				}
-			}
-		}
+			return FVector2D(1.5f * Distance * X, XkCos30 * Distance * (-X - Y - Y));
+		};
+	FBox2D Bounds(ForceInit);
+	for (const FIntPoint& ChunkKey : InChunkKeys)
+	{
+		const int32 MinX = ChunkKey.X << HEXAGON_CHUNK_SHIFT;
+		const int32 MinY = ChunkKey.Y << HEXAGON_CHUNK_SHIFT;
+		const int32 MaxX = MinX + HEXAGON_CHUNK_SIZE - 1;
+		const int32 MaxY = MinY + HEXAGON_CHUNK_SIZE - 1;
+		Bounds += GetCoordPosition(MinX, MinY);
+		Bounds += GetCoordPosition(MinX, MaxY);
+		Bounds += GetCoordPosition(MaxX, MinY);
+		Bounds += GetCoordPosition(MaxX, MaxY);
 	}
+	return Bounds.bIsValid ? Bounds.ExpandBy(Distance) : Bounds;
 }
 
 
-void AXkSphericalWorldWithOceanActor::GenerateHexagonalWorld()
+void AXkSphericalWorldWithOceanActor::RegenerateWorld()
 {
-	TRACE_CPUPROFILER_EVENT_SCOPE(AXkSphericalWorldWithOceanActor::GenerateHexagonalWorld);
+	RegenerateJob.Cancel();
+	ChunkStreamer.Shutdown();
+	GetHexagonalWorldTable()->SetStreamingChunks(false);
+	if (bStreamChunks)
+	{
+		StartChunkStreaming();
+		GenerateCanvas();
+		return;
+	}
+	if (!LoadCookedWorld() && !LoadGenerateCache())
+	{
+		GenerateHexagons();
+		GenerateHexagonalWorld();
+		SaveGenerateCache();
+	}
+	GenerateCanvas();
+}
+
+
+void AXkSphericalWorldWithOceanActor::RegenerateWorldAsync()
+{
+	// Streaming and cooked worlds are cheap to set up, only generating the whole world goes to workers.
+	if (bStreamChunks || FPaths::FileExists(GetCookedWorldFilename()))
+	{
+		RegenerateWorld();
+		return;
+	}
+	ChunkStreamer.Shutdown();
+	GetHexagonalWorldTable()->SetStreamingChunks(false);
+	RegenerateJob.Start(MakeGenerateSettings(), bUseGenerateCache ? GetGenerateCacheKey() : FString());
+}
+
+
+bool AXkSphericalWorldWithOceanActor::ApplyRegenerateResult()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(AXkSphericalWorldWithOceanActor::ApplyRegenerateResult);
+
+	FXkHexagonalWorldGenerateResultPtr Result = RegenerateJob.TakeResult();
+	if (!Result.IsValid() || !GetWorld())
+	{
+		return false;
+	}
+
+	// Swap everything in this frame, readers never see a half regenerated world.
+	ReleaseHexagonActors();
+	HexagonalWorldGrid = MoveTemp(Result->Grid);
+	LastGenerateStats = Result->Stats;
+	ModifyHexagonalWorldNodes() = MoveTemp(Result->Nodes);
+	MarkHexagonalWorldDirty();
+	ResizeHexagonInfluenceMap(HexagonalWorldGrid.MaxManhattanDistance);
+	SpawnHexagonActors();
+	DrawCanvasInstances(Result->InstancePositions, Result->InstanceWeights);
+	return true;
+}
+
+
+bool AXkSphericalWorldWithOceanActor::LoadGenerateCache()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(AXkSphericalWorldWithOceanActor::LoadGenerateCache);
+
+	if (!bUseGenerateCache || !GetWorld())
+	{
+		return false;
+	}
+	const FXkHexagonalWorldGenerateCache GenerateCache;
+	if (!GenerateCache.Load(GetGenerateCacheKey(), MakeGenerateSettings(), HexagonalWorldGrid))
+	{
+		return false;
+	}
+
+	ReleaseHexagonActors();
+	LastGenerateStats = FXkHexagonGenerateStats();
+	LastGenerateStats.NodeNum = HexagonalWorldGrid.NodeCells.Num();
+	HexagonalWorldGrid.FillNodes(ModifyHexagonalWorldNodes());
+	MarkHexagonalWorldDirty();
+	ResizeHexagonInfluenceMap(HexagonalWorldGrid.MaxManhattanDistance);
+	SpawnHexagonActors();
+	return true;
+}
+
+
+void AXkSphericalWorldWithOceanActor::SaveGenerateCache()
+{
+	if (!bUseGenerateCache)
+	{
+		return;
+	}
+	Async(EAsyncExecution::ThreadPool, [Grid = HexagonalWorldGrid, CacheKey = GetGenerateCacheKey()]()
+		{
+			const FXkHexagonalWorldGenerateCache GenerateCache;
+			GenerateCache.Save(CacheKey, Grid);
+		});
+}
+
+
+bool AXkSphericalWorldWithOceanActor::CanUpdateWorld() const
+{
+	const FXkHexagonalWorldGenerateSettings Settings = MakeGenerateSettings();
+	return !RegenerateJob.IsRunning() && !RegenerateJob.IsReady() && !ChunkStreamer.IsStreaming() && !GetCookedWorld()
+		&& HexagonalWorldGrid.CompletedStageNum == (int32)EXkHexagonGenerateStage::Num
+		&& FXkHexagonalWorldGenerator::GetStageHash(HexagonalWorldGrid.GeneratedSettings, EXkHexagonGenerateStage::Layout) == FXkHexagonalWorldGenerator::GetStageHash(Settings, EXkHexagonGenerateStage::Layout);
+}
+
+
+void AXkSphericalWorldWithOceanActor::UpdateWorld()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(AXkSphericalWorldWithOceanActor::UpdateWorld);
 
 	if (!GetWorld())
 	{
 		return;
 	}
+	if (!CanUpdateWorld())
+	{
+		RegenerateWorldAsync();
+		return;
+	}
+
+	const FXkHexagonalWorldGenerator Generator(MakeGenerateSettings());
+	TArray<FIntVector> ChangedCoords;
+	Generator.Regenerate(HexagonalWorldGrid, ChangedCoords, &LastGenerateStats);
+	ResizeHexagonInfluenceMap(HexagonalWorldGrid.MaxManhattanDistance);
+	if (ChangedCoords.Num() == 0)
+	{
+		return;
+	}
+
+	// Patch the changed nodes only, the journal and snapshot pages see each of them.
+	TMap<FIntVector, FXkHexagonNode>& HexagonalWorldNodes = ModifyHexagonalWorldNodes();
+	FBox2D DirtyBounds(ForceInit);
+	const int32 R = HexagonalWorldGrid.MaxManhattanDistance;
+	for (const FIntVector& Coord : ChangedCoords)
+	{
+		const FXkHexagonNode* OldNode = HexagonalWorldNodes.Find(Coord);
+		if (OldNode)
+		{
+			DirtyBounds += FVector2D(OldNode->Position.X, OldNode->Position.Y);
+		}
+		const bool bInGrid = FMath::Abs(Coord.X) <= R && FMath::Abs(Coord.Y) <= R;
+		const int32 CellIndex = bInGrid ? HexagonalWorldGrid.GetCellIndex(Coord.X, Coord.Y) : INDEX_NONE;
+		if (CellIndex != INDEX_NONE && HexagonalWorldGrid.Types[CellIndex] != 0)
+		{
+			const EXkHexagonNodeField Fields = OldNode ? EXkHexagonNodeField::All : EXkHexagonNodeField::Added;
+			const FXkHexagonNode& NewNode = HexagonalWorldNodes.Add(Coord, HexagonalWorldGrid.MakeNode(CellIndex));
+			DirtyBounds += FVector2D(NewNode.Position.X, NewNode.Position.Y);
+			MarkHexagonNodeDirty(Coord, Fields);
+		}
+		else if (OldNode)
+		{
+			HexagonalWorldNodes.Remove(Coord);
+			MarkHexagonNodeDirty(Coord, EXkHexagonNodeField::Removed);
+		}
+	}
+	RefreshHexagonActors(ChangedCoords);
+
+	TArray<FVector4f> InstancePositionData;
+	TArray<FVector4f> InstanceWeightData;
+	FXkHexagonalWorldGenerateJob::BuildCanvasInstances(HexagonalWorldNodes, InstancePositionData, InstanceWeightData);
+	DirtyBounds = DirtyBounds.ExpandBy(Radius + GapWidth);
+	DrawCanvasInstances(InstancePositionData, InstanceWeightData, &DirtyBounds);
+}
+
+
+void AXkSphericalWorldWithOceanActor::SpawnHexagonActors()
+{
+	UXkHexagonActorPoolSubsystem* HexagonActorPool = UXkHexagonActorPoolSubsystem::Get(GetWorld());
+	if (!bSpawnActors || !HexagonActorPool)
+	{
+		return;
+	}
+	// Keep a whole world of released actors, the next regeneration takes them back.
+	HexagonActorPool->SetMaxFreeActorNum(this, GetSpawnActorNum());
+	// The node table rather than the grid, cooked worlds fill the table only.
+	for (const TPair<FIntVector, FXkHexagonNode>& NodePair : ModifyHexagonalWorldNodes())
+	{
+		const int32 ManhattanDistanceToCenter = FXkHexagonAStarPathfinding::CalcManhattanDistance(NodePair.Key, FIntVector(0, 0, 0));
+		if (ManhattanDistanceToCenter < SpawnActorsMaxMhtDist)
+		{
+			SpawnHexagonActor(NodePair.Key, NodePair.Value.Position);
+		}
+	}
+}
+
+
+AXkHexagonActor* AXkSphericalWorldWithOceanActor::SpawnHexagonActor(const FIntVector& HexagonCoord, const FVector4f& Position)
+{
+	UXkHexagonActorPoolSubsystem* HexagonActorPool = UXkHexagonActorPoolSubsystem::Get(GetWorld());
+	AXkHexagonActor* HexagonActor = HexagonActorPool ? HexagonActorPool->Acquire(this, HexagonCoord) : nullptr;
+	if (HexagonActor)
+	{
+		HexagonActor->SetActorLocation(FVector(Position.X, Position.Y, Position.Z + 200.0));
+	}
+	return HexagonActor;
+}
+
+
+int32 AXkSphericalWorldWithOceanActor::GetSpawnActorNum() const
+{
+	// Hexagons within distance D of a hexagon are 3 * D * (D + 1) + 1.
+	const int32 Distance = SpawnActorsMaxMhtDist - 1;
+	return Distance < 0 ? 0 : 3 * Distance * (Distance + 1) + 1;
+}
+
+
+void AXkSphericalWorldWithOceanActor::ReleaseHexagonActors()
+{
+	if (UXkHexagonActorPoolSubsystem* HexagonActorPool = UXkHexagonActorPoolSubsystem::Get(GetWorld()))
+	{
+		HexagonActorPool->ReleaseAll(this);
+	}
+}
+
+
+void AXkSphericalWorldWithOceanActor::RefreshHexagonActors(const TArray<FIntVector>& InChangedCoords)
+{
+	UXkHexagonActorPoolSubsystem* HexagonActorPool = UXkHexagonActorPoolSubsystem::Get(GetWorld());
+	if (!bSpawnActors || !HexagonActorPool)
+	{
+		return;
+	}
+	for (const FIntVector& Coord : InChangedCoords)
+	{
+		const FXkHexagonNode* HexagonNode = GetHexagonNode(Coord);
+		if (HexagonNode && FXkHexagonAStarPathfinding::CalcManhattanDistance(Coord, FIntVector(0, 0, 0)) < SpawnActorsMaxMhtDist)
+		{
+			// The actor already at the coord is placed again.
+			SpawnHexagonActor(Coord, HexagonNode->Position);
+		}
+		else
+		{
+			HexagonActorPool->Release(this, Coord);
+		}
+	}
+}
+
 
-	TArray<FIntVector> AllNodes;
-	ModifyHexagonalWorldNodes().GenerateKeyArray(AllNodes);
+void AXkSphericalWorldWithOceanActor::SaveCookedWorld()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(AXkSphericalWorldWithOceanActor::SaveCookedWorld);
 
-	// final deal with nodes splat
-	for (const FIntVector& NodeCoord : AllNodes)
+	const FString Filename = GetCookedWorldFilename();
+	if (Filename.IsEmpty())
 	{
-		int32 ManhattanDistanceToCenter = FXkHexagonAStarPathfinding::CalcManhattanDistance(NodeCoord, FIntVector(0, 0, 0));
-		FXkHexagonNode* Node = GetHexagonNode(NodeCoord);
-		if (Node && ManhattanDistanceToCenter < GroundManhattanDistance)
+		UE_LOG(LogXkGamedevCore, Warning, TEXT("%s has no CookedWorldFile to save into"), *GetName());
+		return;
+	}
+	if (ChunkStreamer.IsStreaming())
+	{
+		UE_LOG(LogXkGamedevCore, Warning, TEXT("%s streams chunks, the node table is partial and would not be saved"), *GetName());
+		return;
+	}
+	// Release the mapping first, the file may be the one currently mapped.
+	CookedWorld.Reset();
+	FXkHexagonalWorldFile::Save(Filename, ModifyHexagonalWorldNodes(), Radius, GapWidth);
+}
+
+
+bool AXkSphericalWorldWithOceanActor::LoadCookedWorld()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(AXkSphericalWorldWithOceanActor::LoadCookedWorld);
+
+	ChunkStreamer.Shutdown();
+	if (!OpenCookedWorld())
+	{
+		return false;
+	}
+
+	ReleaseHexagonActors();
+	CookedWorld->FillNodes(ModifyHexagonalWorldNodes());
+	MarkHexagonalWorldDirty();
+	ResizeHexagonInfluenceMap(CookedWorld->GetHeader().MaxManhattanDistance);
+	SpawnHexagonActors();
+	return true;
+}
+
+
+bool AXkSphericalWorldWithOceanActor::OpenCookedWorld()
+{
+	// Chunk loaders may still hold the previous mapping, open a new one instead of reusing it.
+	CookedWorld.Reset();
+
+	const FString Filename = GetCookedWorldFilename();
+	if (Filename.IsEmpty() || !FPaths::FileExists(Filename))
+	{
+		return false;
+	}
+	TSharedPtr<FXkHexagonalWorldFile, ESPMode::ThreadSafe> WorldFile = MakeShared<FXkHexagonalWorldFile, ESPMode::ThreadSafe>();
+	if (!WorldFile->Open(Filename))
+	{
+		return false;
+	}
+	const FXkHexagonalWorldFileHeader& Header = WorldFile->GetHeader();
+	if (!FMath::IsNearlyEqual(Header.Radius, Radius) || !FMath::IsNearlyEqual(Header.GapWidth, GapWidth))
+	{
+		UE_LOG(LogXkGamedevCore, Warning, TEXT("%s was cooked with another hexagon size, generating instead"), *Filename);
+		return false;
+	}
+	CookedWorld = WorldFile;
+	return true;
+}
+
+
+void AXkSphericalWorldWithOceanActor::StartChunkStreaming()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(AXkSphericalWorldWithOceanActor::StartChunkStreaming);
+
+	ChunkStreamer.Shutdown();
+	ReleaseHexagonActors();
+
+	FXkHexagonalWorldChunkStreamer::FChunkLoader ChunkLoader;
+	if (OpenCookedWorld())
+	{
+		ResizeHexagonInfluenceMap(CookedWorld->GetHeader().MaxManhattanDistance);
+		TSharedPtr<FXkHexagonalWorldFile, ESPMode::ThreadSafe> WorldFile = CookedWorld;
+		ChunkLoader = [WorldFile](const FIntPoint& InChunkKey, TArray<FXkHexagonNode>& OutNodes)
 		{
-			Node->Type = EXkHexagonType::Land;
-			float RandomSeed = FVector2D(Node->Position.X, Node->Position.Y).Length();
-			for (const FXkHexagonSplat& HexagonSplat : HexagonSplats)
+			for (int32 X = InChunkKey.X << HEXAGON_CHUNK_SHIFT; X < (InChunkKey.X + 1) << HEXAGON_CHUNK_SHIFT; X++)
 			{
-				if (Node->Type == HexagonSplat.TargetType)
+				for (int32 Y = InChunkKey.Y << HEXAGON_CHUNK_SHIFT; Y < (InChunkKey.Y + 1) << HEXAGON_CHUNK_SHIFT; Y++)
 				{
-					Node->Position.Z = HexagonSplat.Height;
-					Node->Splatmap = HexagonSplat.Splats[RandRangeIntMT(RandomSeed, 0, HexagonSplat.Splats.Num() - 1)];
+					FXkHexagonNode Node;
+					if (WorldFile->GetNode(FIntVector(X, Y, -X - Y), Node))
+					{
+						OutNodes.Add(Node);
+					}
 				}
 			}
-		}
-		else if (Node && ManhattanDistanceToCenter < (GroundManhattanDistance + ShorelineManhattanDistance))
+		};
+	}
+	else
+	{
+		const FXkHexagonalWorldGenerateSettings Settings = MakeGenerateSettings();
+		ResizeHexagonInfluenceMap(Settings.GetMaxManhattanDistance());
+		ChunkLoader = [Settings](const FIntPoint& InChunkKey, TArray<FXkHexagonNode>& OutNodes)
 		{
-			Node->Type = EXkHexagonType::Sand;
-			float RandomSeed = FVector2D(Node->Position.X, Node->Position.Y).Length();
-			for (const FXkHexagonSplat& HexagonSplat : HexagonSplats)
+			for (int32 X = InChunkKey.X << HEXAGON_CHUNK_SHIFT; X < (InChunkKey.X + 1) << HEXAGON_CHUNK_SHIFT; X++)
 			{
-				if (Node->Type == HexagonSplat.TargetType)
+				for (int32 Y = InChunkKey.Y << HEXAGON_CHUNK_SHIFT; Y < (InChunkKey.Y + 1) << HEXAGON_CHUNK_SHIFT; Y++)
 				{
-					Node->Position.Z = HexagonSplat.Height;
-					Node->Splatmap = HexagonSplat.Splats[RandRangeIntMT(RandomSeed, 0, HexagonSplat.Splats.Num() - 1)];
+					FXkHexagonNode Node;
+					if (Settings.GenerateNode(FIntVector(X, Y, -X - Y), Node))
+					{
+						OutNodes.Add(Node);
+					}
 				}
 			}
-		}
+		};
 	}
+	ChunkStreamer.Initialize(GetHexagonalWorldTable(), MoveTemp(ChunkLoader));
 }
 
 
-void AXkSphericalWorldWithOceanActor::GenerateCanvas()
+FVector AXkSphericalWorldWithOceanActor::GetStreamingCenter() const
 {
-	TRACE_CPUPROFILER_EVENT_SCOPE(AXkSphericalWorldWithOceanActor::GenerateCanvas);
+	if (APlayerController* PlayerController = GetWorld() ? GetWorld()->GetFirstPlayerController() : nullptr)
+	{
+		if (AXkTopDownCamera* TopDownCamera = Cast<AXkTopDownCamera>(PlayerController->GetPawn()))
+		{
+			return TopDownCamera->GetActorLocation();
+		}
+		if (PlayerController->PlayerCameraManager)
+		{
+			return PlayerController->PlayerCameraManager->GetCameraLocation();
+		}
+	}
+	return GetActorLocation();
+}
 
-	// get vertex
-	TArray<FVector4f> OutVertices; TArray<uint32> OutIndices;
-	BuildHexagonData(OutVertices, OutIndices);
 
-	// get instance
-	TArray<FXkHexagonNode> HexagonalWorldNodes;
-	ModifyHexagonalWorldNodes().GenerateValueArray(HexagonalWorldNodes);
-	int NunInstances = HexagonalWorldNodes.Num();
-	TArray<FVector4f> InstancePositionData;
-	TArray<FVector4f> InstanceWeightData;
-	for (int i = 0; i < NunInstances; i++)
-	{
-		const FXkHexagonNode& Node = HexagonalWorldNodes[i];
-		FVector4f InstancePositionValue = Node.Position;
-		FVector4f InstanceWeightValue = FVector4f(FVector3f(1.0), (float)Node.Splatmap / 255.0f);
+FXkHexagonalWorldGenerateSettings AXkSphericalWorldWithOceanActor::MakeGenerateSettings() const
+{
+	FXkHexagonalWorldGenerateSettings Settings;
+	Settings.Radius = Radius;
+	Settings.GapWidth = GapWidth;
+	Settings.GroundManhattanDistance = GroundManhattanDistance;
+	Settings.ShorelineManhattanDistance = ShorelineManhattanDistance;
+	Settings.WorldSeed = WorldSeed;
+	Settings.HeightNoiseSize = HeightNoiseSize;
+	Settings.HexagonSplats = HexagonSplats;
+	return Settings;
+}
 
-		InstancePositionData.Add(InstancePositionValue);
-		InstanceWeightData.Add(InstanceWeightValue);
-	}
 
-	FVector2D Resolution = CanvasRendererComponent->GetCanvasSize();
-	FVector2D HexagonalWorldExtent = GetHexagonalWorldExtent();
-	FVector2D UnscaledPatchCoverage = FVector2D(FMath::Max(HexagonalWorldExtent.X, HexagonalWorldExtent.Y) * 2.0);
-	FVector2D FullUnscaledWorldSize = GetFullUnscaledWorldSize(UnscaledPatchCoverage, Resolution);
-	FVector4f CanvasExtent = CanvasRendererComponent->GetCanvasExtent();
-	CanvasExtent.X = FullUnscaledWorldSize.X;
-	CanvasExtent.Y = FullUnscaledWorldSize.Y;
-	CanvasRendererComponent->SetCanvasExtent(CanvasExtent);
-	CanvasRendererComponent->CreateBuffers(OutVertices, OutIndices, InstancePositionData, InstanceWeightData);
-	CanvasRendererComponent->DrawCanvas();
+FString AXkSphericalWorldWithOceanActor::GetGenerateCacheKey() const
+{
+	// Properties of the actor the generator does not read, the max manhattan distance is derived from the settings.
+	TArray<uint8> ExtraInputs;
+	FMemoryWriter Writer(ExtraInputs);
+	FVector2D RandomRange = PositionRandomRange;
+	Writer << RandomRange;
+	return FXkHexagonalWorldGenerateCache::MakeKey(MakeGenerateSettings(), ExtraInputs);
 }
 
 
-void AXkSphericalWorldWithOceanActor::RegenerateWorld()
+FString AXkSphericalWorldWithOceanActor::GetCookedWorldFilename() const
 {
-	GenerateHexagons();
-	GenerateHexagonalWorld();
-	GenerateCanvas();
+	if (CookedWorldFile.IsEmpty())
+	{
+		return FString();
+	}
+	// The staged directory, a file anywhere else in Content would not be packaged.
+	return FPaths::ConvertRelativePathToFull(FPaths::ProjectContentDir() / HEXAGON_WORLD_FILE_DIRECTORY, CookedWorldFile);
 }
\ No newline at end of file
@@ -0,0 +1,227 @@
+// Copyright ©ICEPRINCE. All Rights Reserved.
+
+#include "XkHexagon/XkHexagonActorPool.h"
+#include "XkHexagon/XkHexagonActors.h"
+#include "Engine/World.h"
+
+
+UXkHexagonActorPoolSubsystem::UXkHexagonActorPoolSubsystem()
+{
+	DefaultMaxFreeActorNum = 256;
+	MaxFreeActorNum = DefaultMaxFreeActorNum;
+	MaxDestroyedActorsPerTick = 16;
+}
+
+
+UXkHexagonActorPoolSubsystem* UXkHexagonActorPoolSubsystem::Get(const UWorld* InWorld)
+{
+	return InWorld ? InWorld->GetSubsystem<UXkHexagonActorPoolSubsystem>() : nullptr;
+}
+
+
+void UXkHexagonActorPoolSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	// A world destroyed without clearing its budget no longer keeps actors.
+	UpdateMaxFreeActorNum();
+	// Shrink gradually, destroying a whole regenerated world of actors at once would hitch.
+	int32 DestroyedNum = 0;
+	while (FreeActors.Num() > MaxFreeActorNum && DestroyedNum < MaxDestroyedActorsPerTick)
+	{
+		AXkHexagonActor* HexagonActor = FreeActors.Pop(false).Get();
+		if (IsValid(HexagonActor))
+		{
+			HexagonActor->Destroy();
+			DestroyedNum++;
+		}
+	}
+}
+
+
+TStatId UXkHexagonActorPoolSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UXkHexagonActorPoolSubsystem, STATGROUP_Tickables);
+}
+
+
+bool UXkHexagonActorPoolSubsystem::DoesSupportWorldType(EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::Editor || WorldType == EWorldType::PIE;
+}
+
+
+void UXkHexagonActorPoolSubsystem::Deinitialize()
+{
+	// The actors go with their level.
+	ActiveActors.Empty();
+	FreeActors.Empty();
+	WorldMaxFreeActorNums.Empty();
+
+	Super::Deinitialize();
+}
+
+
+void UXkHexagonActorPoolSubsystem::SetMaxFreeActorNum(const AXkHexagonalWorldActor* InHexagonalWorld, const int32 InNum)
+{
+	WorldMaxFreeActorNums.Add(FObjectKey(InHexagonalWorld), FMath::Max(InNum, 0));
+	UpdateMaxFreeActorNum();
+}
+
+
+void UXkHexagonActorPoolSubsystem::ClearMaxFreeActorNum(const AXkHexagonalWorldActor* InHexagonalWorld)
+{
+	WorldMaxFreeActorNums.Remove(FObjectKey(InHexagonalWorld));
+	UpdateMaxFreeActorNum();
+}
+
+
+void UXkHexagonActorPoolSubsystem::UpdateMaxFreeActorNum()
+{
+	// Every world may regenerate next and take back a whole world of actors, the largest budget covers each.
+	int32 NewMaxFreeActorNum = 0;
+	for (auto It = WorldMaxFreeActorNums.CreateIterator(); It; ++It)
+	{
+		if (!It.Key().ResolveObjectPtr())
+		{
+			It.RemoveCurrent();
+			continue;
+		}
+		NewMaxFreeActorNum = FMath::Max(NewMaxFreeActorNum, It.Value());
+	}
+	MaxFreeActorNum = WorldMaxFreeActorNums.Num() > 0 ? NewMaxFreeActorNum : DefaultMaxFreeActorNum;
+}
+
+
+void UXkHexagonActorPoolSubsystem::Prewarm(const int32 InNum)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UXkHexagonActorPoolSubsystem::Prewarm);
+
+	while (FreeActors.Num() < InNum)
+	{
+		AXkHexagonActor* HexagonActor = SpawnFreeActor();
+		if (!HexagonActor)
+		{
+			return;
+		}
+		FreeActors.Add(HexagonActor);
+	}
+}
+
+
+AXkHexagonActor* UXkHexagonActorPoolSubsystem::Acquire(AXkHexagonalWorldActor* InHexagonalWorld, const FIntVector& InCoord)
+{
+	if (!IsValid(InHexagonalWorld))
+	{
+		return nullptr;
+	}
+
+	TMap<FIntVector, TWeakObjectPtr<AXkHexagonActor>>& WorldActors = ActiveActors.FindOrAdd(FObjectKey(InHexagonalWorld));
+	AXkHexagonActor* HexagonActor = WorldActors.FindRef(InCoord).Get();
+	if (!IsValid(HexagonActor))
+	{
+		HexagonActor = nullptr;
+		while (!HexagonActor && FreeActors.Num() > 0)
+		{
+			HexagonActor = FreeActors.Pop(false).Get();
+			HexagonActor = IsValid(HexagonActor) ? HexagonActor : nullptr;
+		}
+		if (!HexagonActor)
+		{
+			HexagonActor = SpawnFreeActor();
+		}
+		if (!HexagonActor)
+		{
+			return nullptr;
+		}
+		WorldActors.Add(InCoord, HexagonActor);
+	}
+
+	const bool bWorldChanged = HexagonActor->GetHexagonalWorld().Get() != InHexagonalWorld;
+	HexagonActor->SetHexagonWorld(InHexagonalWorld);
+	if (HexagonActor->GetAttachParentActor() != InHexagonalWorld)
+	{
+		HexagonActor->AttachToActor(InHexagonalWorld, FAttachmentTransformRules::KeepWorldTransform);
+	}
+	HexagonActor->InitHexagon(InCoord);
+#if WITH_EDITOR
+	FString CoordString = FString::Printf(
+		TEXT("HexagonActor(%i, %i, %i)"), InCoord.X, InCoord.Y, InCoord.Z);
+	HexagonActor->SetActorLabel(CoordString);
+#endif
+	// The procedural mesh depends on the sizes of the world, a reused actor only needs its colors back.
+	if (bWorldChanged)
+	{
+		HexagonActor->ConstructionScripts();
+	}
+	else
+	{
+		HexagonActor->UpdateMaterial();
+	}
+	return HexagonActor;
+}
+
+
+void UXkHexagonActorPoolSubsystem::Release(const AXkHexagonalWorldActor* InHexagonalWorld, const FIntVector& InCoord)
+{
+	TMap<FIntVector, TWeakObjectPtr<AXkHexagonActor>>* WorldActors = ActiveActors.Find(FObjectKey(InHexagonalWorld));
+	TWeakObjectPtr<AXkHexagonActor> HexagonActor;
+	if (!WorldActors || !WorldActors->RemoveAndCopyValue(InCoord, HexagonActor))
+	{
+		return;
+	}
+	if (IsValid(HexagonActor.Get()))
+	{
+		HexagonActor->FreeHexagon();
+		FreeActors.Add(HexagonActor);
+	}
+}
+
+
+void UXkHexagonActorPoolSubsystem::ReleaseAll(const AXkHexagonalWorldActor* InHexagonalWorld)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UXkHexagonActorPoolSubsystem::ReleaseAll);
+
+	TMap<FIntVector, TWeakObjectPtr<AXkHexagonActor>> WorldActors;
+	if (!ActiveActors.RemoveAndCopyValue(FObjectKey(InHexagonalWorld), WorldActors))
+	{
+		return;
+	}
+	for (const TPair<FIntVector, TWeakObjectPtr<AXkHexagonActor>>& ActorPair : WorldActors)
+	{
+		AXkHexagonActor* HexagonActor = ActorPair.Value.Get();
+		if (IsValid(HexagonActor))
+		{
+			HexagonActor->FreeHexagon();
+			FreeActors.Add(HexagonActor);
+		}
+	}
+}
+
+
+AXkHexagonActor* UXkHexagonActorPoolSubsystem::Find(const AXkHexagonalWorldActor* InHexagonalWorld, const FIntVector& InCoord) const
+{
+	const TMap<FIntVector, TWeakObjectPtr<AXkHexagonActor>>* WorldActors = ActiveActors.Find(FObjectKey(InHexagonalWorld));
+	AXkHexagonActor* HexagonActor = WorldActors ? WorldActors->FindRef(InCoord).Get() : nullptr;
+	return IsValid(HexagonActor) ? HexagonActor : nullptr;
+}
+
+
+AXkHexagonActor* UXkHexagonActorPoolSubsystem::SpawnFreeActor()
+{
+	UWorld* World = GetWorld();
+	if (!World)
+	{
+		return nullptr;
+	}
+	FActorSpawnParameters ActorSpawnParameters;
+	ActorSpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	AXkHexagonActor* HexagonActor = World->SpawnActor<AXkHexagonActor>(AXkHexagonActor::StaticClass(), FVector(0.0, 0.0, -HALF_WORLD_MAX), FRotator(0.0), ActorSpawnParameters);
+	if (!HexagonActor)
+	{
+		return nullptr;
+	}
+	HexagonActor->SetFlags(RF_Transient);
+	HexagonActor->FreeHexagon();
+	return HexagonActor;
+}
@@ -3,6 +3,7 @@
 #include "XkHexagon/XkHexagonActors.h"
 #include "XkHexagon/XkHexagonPathfinding.h"
 #include "EngineUtils.h"
+#include "Algo/Reverse.h"
 #include "ProceduralMeshComponent.h"
 #include "GenericPlatform/GenericPlatformMath.h"
 #include "LandscapeStreamingProxy.h"
@@ -45,11 +46,17 @@ AXkHexagonActor::AXkHexagonActor(const FObjectInitializer& ObjectInitializer)
 	BaseMaterial = ObjectFinder2.Object;
 	static ConstructorHelpers::FObjectFinder<UMaterialInterface> ObjectFinder3(TEXT("/XkGamedevKit/Materials/M_HexagonEdge.M_HexagonEdge"));
 	EdgeMaterial = ObjectFinder3.Object;
+	BaseMID = nullptr;
+	EdgeMID = nullptr;
+
+	AppliedColorHash = 0;
+	AppliedGeometryHash = 0;
 }
 
 
 void AXkHexagonActor::ConstructionScripts()
 {
+	RegisterToHexagonalWorld();
 	UpdateMaterial();
 #if WITH_EDITOR
 	UpdateProcMesh();
@@ -65,6 +72,13 @@ void AXkHexagonActor::OnConstruction(const FTransform& Transform)
 }
 
 
+void AXkHexagonActor::Destroyed()
+{
+	UnregisterFromHexagonalWorld();
+	Super::Destroyed();
+}
+
+
 #if WITH_EDITOR
 void AXkHexagonActor::PostEditMove(bool bFinished)
 {
@@ -79,6 +93,7 @@ void AXkHexagonActor::PostEditMove(bool bFinished)
 			FVector4f Position = HexagonNode->Position;
 			FVector NewLocation = FVector(Position.X, Position.Y, Location.Z);
 			HexagonNode->Position = FVector4f(NewLocation.X, NewLocation.Y, NewLocation.Z, 1.0f);
+			ParentHexagonalWorld->MarkHexagonNodeDirty(HexagonNode->Coord, EXkHexagonNodeField::Position | EXkHexagonNodeField::Height);
 			SetActorLocation(NewLocation, true);
 		}
 	}
@@ -86,54 +101,132 @@ void AXkHexagonActor::PostEditMove(bool bFinished)
 #endif
 
 
+void AXkHexagonActor::RefreshHexagon()
+{
+	if (!ParentHexagonalWorld.IsValid())
+	{
+		return;
+	}
+	RegisterToHexagonalWorld();
+	if (AppliedColorHash != ParentHexagonalWorld->GetHexagonColorHash())
+	{
+		UpdateMaterial();
+	}
+#if WITH_EDITOR
+	if (AppliedGeometryHash != ParentHexagonalWorld->GetHexagonGeometryHash())
+	{
+		UpdateProcMesh();
+	}
+#endif
+}
+
+
+void AXkHexagonActor::SetCoord(const FIntVector& Input)
+{
+	UnregisterFromHexagonalWorld();
+	Coord = Input;
+	RegisterToHexagonalWorld();
+}
+
+
 void AXkHexagonActor::SetHexagonWorld(class AXkHexagonalWorldActor* Input)
 {
+	UnregisterFromHexagonalWorld();
 	ParentHexagonalWorld = MakeWeakObjectPtr<AXkHexagonalWorldActor>(Input);
+	RegisterToHexagonalWorld();
 }
 
 
-void AXkHexagonActor::OnBaseHighlight(const FLinearColor& InColor)
+void AXkHexagonActor::RegisterToHexagonalWorld()
 {
-	if (IsValid(BaseMID))
+	// Free actors of the pool are hidden and show no hexagon.
+	if (ParentHexagonalWorld.IsValid() && StaticProcMesh->IsVisible())
 	{
-		BaseMID->SetVectorParameterValue(FName("Color"), InColor);
+		ParentHexagonalWorld->RegisterHexagonActor(this);
 	}
 }
 
 
-void AXkHexagonActor::OnEdgeHighlight(const FLinearColor& InColor)
+void AXkHexagonActor::UnregisterFromHexagonalWorld()
 {
-	if (IsValid(EdgeMID))
+	if (ParentHexagonalWorld.IsValid())
 	{
-		EdgeMID->SetVectorParameterValue(FName("Color"), InColor);
+		ParentHexagonalWorld->UnregisterHexagonActor(this);
 	}
 }
 
 
+void AXkHexagonActor::OnBaseHighlight(const FLinearColor& InColor)
+{
+	SetHexagonColor(BASE_COLOR_PRIMITIVE_DATA_INDEX, InColor);
+}
+
+
+void AXkHexagonActor::OnEdgeHighlight(const FLinearColor& InColor)
+{
+	SetHexagonColor(EDGE_COLOR_PRIMITIVE_DATA_INDEX, InColor);
+}
+
+
 void AXkHexagonActor::UpdateMaterial()
 {
-	if (!BaseMID && BaseMaterial)
+	if (ParentHexagonalWorld.IsValid() && ParentHexagonalWorld->bHexagonColorsInPrimitiveData)
 	{
-		BaseMID = UMaterialInstanceDynamic::Create(BaseMaterial, this);
+		BaseMID = nullptr;
+		EdgeMID = nullptr;
 	}
-	if (BaseMID && IsValid(BaseMID) && ParentHexagonalWorld.IsValid())
+	else
+	{
+		if (!BaseMID && BaseMaterial)
+		{
+			BaseMID = UMaterialInstanceDynamic::Create(BaseMaterial, this);
+		}
+		if (!EdgeMID && EdgeMaterial)
+		{
+			EdgeMID = UMaterialInstanceDynamic::Create(EdgeMaterial, this);
+		}
+	}
+	if (ParentHexagonalWorld.IsValid())
 	{
 		FLinearColor BaseColor = ParentHexagonalWorld->BaseColor;
 		BaseColor.A = 1.0;
-		BaseMID->SetVectorParameterValue(FName("Color"), BaseColor);
+		SetHexagonColor(BASE_COLOR_PRIMITIVE_DATA_INDEX, BaseColor);
+		FLinearColor EdgeColor = ParentHexagonalWorld->EdgeColor;
+		EdgeColor.A = 1.0;
+		SetHexagonColor(EDGE_COLOR_PRIMITIVE_DATA_INDEX, EdgeColor);
+		AppliedColorHash = ParentHexagonalWorld->GetHexagonColorHash();
 	}
-	if (!EdgeMID && EdgeMaterial)
+	StaticProcMesh->SetMaterial(0, GetHexagonMaterial(BASE_COLOR_PRIMITIVE_DATA_INDEX));
+	StaticProcMesh->SetMaterial(1, GetHexagonMaterial(EDGE_COLOR_PRIMITIVE_DATA_INDEX));
+#if WITH_EDITORONLY_DATA
+	ProcMesh->SetMaterial(BASE_SECTION_INDEX, GetHexagonMaterial(BASE_COLOR_PRIMITIVE_DATA_INDEX));
+	ProcMesh->SetMaterial(EDGE_SECTION_INDEX, GetHexagonMaterial(EDGE_COLOR_PRIMITIVE_DATA_INDEX));
+#endif
+}
+
+
+UMaterialInterface* AXkHexagonActor::GetHexagonMaterial(const int32 InDataIndex) const
+{
+	if (InDataIndex == EDGE_COLOR_PRIMITIVE_DATA_INDEX)
 	{
-		EdgeMID = UMaterialInstanceDynamic::Create(EdgeMaterial, this);
+		return EdgeMID ? EdgeMID : EdgeMaterial;
 	}
-	if (EdgeMID && IsValid(EdgeMID) && ParentHexagonalWorld.IsValid())
+	return BaseMID ? BaseMID : BaseMaterial;
+}
+
+
+void AXkHexagonActor::SetHexagonColor(const int32 InDataIndex, const FLinearColor& InColor)
+{
+	UMaterialInstanceDynamic* MID = (InDataIndex == EDGE_COLOR_PRIMITIVE_DATA_INDEX) ? EdgeMID : BaseMID;
+	if (IsValid(MID))
 	{
-		FLinearColor EdgeColor = ParentHexagonalWorld->EdgeColor;
-		EdgeColor.A = 1.0;
-		EdgeMID->SetVectorParameterValue(FName("Color"), EdgeColor);
+		MID->SetVectorParameterValue(FName("Color"), InColor);
+		return;
 	}
-	StaticProcMesh->SetMaterial(0, BaseMID);
-	StaticProcMesh->SetMaterial(1, EdgeMID);
+	StaticProcMesh->SetCustomPrimitiveDataVector4(InDataIndex, FVector4(InColor));
+#if WITH_EDITORONLY_DATA
+	ProcMesh->SetCustomPrimitiveDataVector4(InDataIndex, FVector4(InColor));
+#endif
 }
 
 #if WITH_EDITOR
@@ -141,41 +234,15 @@ void AXkHexagonActor::UpdateProcMesh()
 {
 	if (ParentHexagonalWorld.IsValid())
 	{
-		TArray<FVector> BaseVertices;
-		TArray<int32> BaseIndices;
+		const FXkHexagonProcMeshData& ProcMeshData = ParentHexagonalWorld->GetHexagonProcMeshData();
 
-		TArray<FVector> EdgeVertices;
-		TArray<int32> EdgeIndices;
+		ProcMesh->CreateMeshSection(BASE_SECTION_INDEX, ProcMeshData.BaseVertices, ProcMeshData.BaseIndices, TArray<FVector>(), ProcMeshData.BaseUV0s, TArray<FColor>(), TArray<FProcMeshTangent>(), true);
+		ProcMesh->SetMaterial(BASE_SECTION_INDEX, GetHexagonMaterial(BASE_COLOR_PRIMITIVE_DATA_INDEX));
+		ProcMesh->Bounds = ProcMeshData.Bounds;
 
-		BuildHexagon(BaseVertices, BaseIndices, EdgeVertices, EdgeIndices, 
-			ParentHexagonalWorld->Radius, 
-			ParentHexagonalWorld->Height, 
-			ParentHexagonalWorld->BaseInnerGap, 
-			ParentHexagonalWorld->BaseOuterGap, 
-			ParentHexagonalWorld->EdgeInnerGap, 
-			ParentHexagonalWorld->EdgeOuterGap);
-
-		auto GenerateUV = [](const TArray<FVector>& Vertices, const float Radius) -> TArray<FVector2D>
-			{
-				TArray<FVector2D> UV0s;
-				UV0s.Init(FVector2D::ZeroVector, Vertices.Num());
-				for (int32 i = 0; i < Vertices.Num(); i++)
-				{
-					FVector Position = Vertices[i];
-					FVector2D UV = FVector2D(Position.Y, -Position.X);
-					UV = (UV + Radius) / (Radius * 2.0);
-					UV0s[i] = UV;
-				}
-				return UV0s;
-			};
-		TArray<FVector2D> BaseUV0s = GenerateUV(BaseVertices, ParentHexagonalWorld->Radius);
-		ProcMesh->CreateMeshSection(BASE_SECTION_INDEX, BaseVertices, BaseIndices, TArray<FVector>(), BaseUV0s, TArray<FColor>(), TArray<FProcMeshTangent>(), true);
-		ProcMesh->SetMaterial(BASE_SECTION_INDEX, BaseMID);
-		ProcMesh->Bounds = FBoxSphereBounds(BaseVertices, BaseVertices.Num());
-
-		TArray<FVector2D> EdgeUV0s = GenerateUV(EdgeVertices, ParentHexagonalWorld->Radius);
-		ProcMesh->CreateMeshSection(EDGE_SECTION_INDEX, EdgeVertices, EdgeIndices, TArray<FVector>(), EdgeUV0s, TArray<FColor>(), TArray<FProcMeshTangent>(), true);
-		ProcMesh->SetMaterial(EDGE_SECTION_INDEX, EdgeMID);
+		ProcMesh->CreateMeshSection(EDGE_SECTION_INDEX, ProcMeshData.EdgeVertices, ProcMeshData.EdgeIndices, TArray<FVector>(), ProcMeshData.EdgeUV0s, TArray<FColor>(), TArray<FProcMeshTangent>(), true);
+		ProcMesh->SetMaterial(EDGE_SECTION_INDEX, GetHexagonMaterial(EDGE_COLOR_PRIMITIVE_DATA_INDEX));
+		AppliedGeometryHash = ParentHexagonalWorld->GetHexagonGeometryHash();
 	}
 }
 #endif
@@ -183,6 +250,7 @@ void AXkHexagonActor::UpdateProcMesh()
 
 void AXkHexagonActor::InitHexagon(const FIntVector& InCoord)
 {
+	UnregisterFromHexagonalWorld();
 	Coord = InCoord;
 	if (ParentHexagonalWorld.IsValid())
 	{
@@ -196,19 +264,18 @@ void AXkHexagonActor::InitHexagon(const FIntVector& InCoord)
 	}
 	StaticProcMesh->SetVisibility(true);
 	StaticProcMesh->MarkRenderStateDirty();
+	RegisterToHexagonalWorld();
 }
 
 
 void AXkHexagonActor::FreeHexagon()
 {
+	UnregisterFromHexagonalWorld();
 	StaticProcMesh->SetVisibility(false);
 	SetActorLocation(FVector(0.0, 0.0, -HALF_WORLD_MAX));
 	// Clear hight light colors
-	if (BaseMID && IsValid(BaseMID) && EdgeMID && IsValid(EdgeMID))
-	{
-		BaseMID->SetVectorParameterValue(FName("Color"), FLinearColor(1.0, 1.0, 1.0, 0.0));
-		EdgeMID->SetVectorParameterValue(FName("Color"), FLinearColor(1.0, 1.0, 1.0, 0.0));
-	}
+	SetHexagonColor(BASE_COLOR_PRIMITIVE_DATA_INDEX, FLinearColor(1.0, 1.0, 1.0, 0.0));
+	SetHexagonColor(EDGE_COLOR_PRIMITIVE_DATA_INDEX, FLinearColor(1.0, 1.0, 1.0, 0.0));
 }
 
 
@@ -243,54 +310,29 @@ AXkHexagonalWorldActor::AXkHexagonalWorldActor(const FObjectInitializer& ObjectI
 	EdgeOuterGap = 1.0;
 	BaseColor = FLinearColor(1.0, 1.0, 1.0, 0.0);
 	EdgeColor = FLinearColor(1.0, 1.0, 1.0, 0.0);
+	bHexagonColorsInPrimitiveData = false;
 	MaxManhattanDistance = 64;
 
 	PathfindingMaxStep = 9999;
 	BacktrackingMaxStep = 9999;
+	PathfindingDangerCost = 0.0f;
+
+	// Activate ticking in order to publish the node table snapshot every frame.
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = true;
 }
 
 
 void AXkHexagonalWorldActor::DebugPathfinding()
 {
 #if WITH_EDITOR
-	auto FindHexagonActor = [this](const FIntVector& Input) -> AXkHexagonActor*
-		{
-			for (TActorIterator<AXkHexagonActor> It(GetWorld()); It; ++It)
-			{
-				AXkHexagonActor* HexagonActor = *It;
-				if (HexagonActor->GetCoord() == Input)
-				{
-					return HexagonActor;
-				}
-			}
-			return nullptr;
-		};
-
-	auto FindHexagonActors = [FindHexagonActor](const TArray<FIntVector>& Inputs) -> TArray<AXkHexagonActor*>
-		{
-			TArray<class AXkHexagonActor*> Ret;
-			for (const FIntVector& CurrentPoint : Inputs)
-			{
-				if (AXkHexagonActor* HexagonActor = FindHexagonActor(CurrentPoint))
-				{
-					Ret.Insert(HexagonActor, 0);
-				}
-			}
-			return Ret;
-		};
-
 	if (!IsValid(HexagonStarter) || !IsValid(HexagonTargeter))
 	{
 		return;
 	}
 
-	for (TActorIterator<AXkHexagonActor> It(GetWorld()); It; ++It)
-	{
-		AXkHexagonActor* XkHexagonActor = (*It);
-		XkHexagonActor->OnBaseHighlight();
-	}
-	HexagonStarter->OnBaseHighlight(FLinearColor::Yellow);
-	HexagonTargeter->OnBaseHighlight(FLinearColor::Yellow);
+	ClearHexagonHighlights();
+	HighlightHexagons({ HexagonStarter->GetCoord(), HexagonTargeter->GetCoord() }, FLinearColor::Yellow);
 
 	TArray<FIntVector> BlockArea;
 	for (AXkHexagonActor* HexagonActor : HexagonBlockers)
@@ -298,25 +340,24 @@ void AXkHexagonalWorldActor::DebugPathfinding()
 		BlockArea.Add(HexagonActor->GetCoord());
 	}
 
-	TArray<class AXkHexagonActor*> FindingPathHexagonActors;
+	TArray<FIntVector> FindingPathCoords;
 	HexagonAStarPathfinding.Init(&HexagonalWorldTable);
 	HexagonAStarPathfinding.Blocking(BlockArea);
+	HexagonAStarPathfinding.Influencing(&HexagonInfluenceMap, PathfindingDangerCost);
 	if (HexagonAStarPathfinding.Pathfinding(HexagonStarter->GetCoord(), HexagonTargeter->GetCoord(), PathfindingMaxStep))
 	{
-		TArray<FIntVector> BacktrackingList = HexagonAStarPathfinding.Backtracking(BacktrackingMaxStep);
-		FindingPathHexagonActors = FindHexagonActors(BacktrackingList);
+		FindingPathCoords = HexagonAStarPathfinding.Backtracking(BacktrackingMaxStep);
 	}
 	else
 	{
-		TArray<FIntVector> SearchAreaList = HexagonAStarPathfinding.SearchArea();
-		FindingPathHexagonActors = FindHexagonActors(SearchAreaList);
+		FindingPathCoords = HexagonAStarPathfinding.SearchArea();
 	}
-
-	for (int32 i = 0; i < FindingPathHexagonActors.Num(); i++)
+	// Blue fades in from the last coord to the first, one step per call, the component still sends a single update.
+	const int32 StepNum = FindingPathCoords.Num();
+	for (int32 Step = 0; Step < StepNum; Step++)
 	{
-		float Fade = (float)(i + 1) / (float)FindingPathHexagonActors.Num();
-		AXkHexagonActor* XkHexagonActor = FindingPathHexagonActors[i];
-		XkHexagonActor->OnBaseHighlight(FLinearColor(0.0, 0.0, Fade, 1.0));
+		const float Fade = (float)(Step + 1) / (float)StepNum;
+		HighlightHexagons({ FindingPathCoords[StepNum - 1 - Step] }, FLinearColor(0.0, 0.0, Fade, 1.0));
 	}
 #endif
 }
@@ -325,9 +366,18 @@ void AXkHexagonalWorldActor::DebugPathfinding()
 void AXkHexagonalWorldActor::BeginPlay()
 {
 	HexagonAStarPathfinding.Init(&HexagonalWorldTable);
+	HexagonInfluenceMap.Initialize(MaxManhattanDistance);
 	Super::BeginPlay();
 }
 
+void AXkHexagonalWorldActor::TickActor(float DeltaTime, ELevelTick TickType, FActorTickFunction& ThisTickFunction)
+{
+	Super::TickActor(DeltaTime, TickType, ThisTickFunction);
+
+	PublishHexagonalWorldSnapshot();
+}
+
+
 void AXkHexagonalWorldActor::OnConstruction(const FTransform& Transform)
 {
 #if WITH_EDITOR
@@ -351,6 +401,13 @@ void AXkHexagonalWorldActor::OnConstruction(const FTransform& Transform)
 }
 
 
+FXkHexagonalWorldSnapshotPtr AXkHexagonalWorldActor::PublishHexagonalWorldSnapshot() const
+{
+	HexagonalWorldSnapshot = HexagonalWorldTable.PublishSnapshot();
+	return HexagonalWorldSnapshot;
+}
+
+
 FXkHexagonNode* AXkHexagonalWorldActor::GetHexagonNode(const FIntVector& InCoord) const
 {
 	return HexagonalWorldTable.Nodes.Find(InCoord);
@@ -365,6 +422,133 @@ FXkHexagonNode* AXkHexagonalWorldActor::GetHexagonNode(const FVector& InPosition
 }
 
 
+uint32 AXkHexagonalWorldActor::GetHexagonColorHash() const
+{
+	return HashCombine(HashCombine(GetTypeHash(BaseColor), GetTypeHash(EdgeColor)), GetTypeHash(bHexagonColorsInPrimitiveData));
+}
+
+
+void AXkHexagonalWorldActor::HighlightHexagons(const TArray<FIntVector>& InCoords, const FLinearColor& InColor)
+{
+	if (UXkHexagonalWorldComponent* HexagonalWorldComponent = FindComponentByClass<UXkHexagonalWorldComponent>())
+	{
+		HexagonalWorldComponent->SetHexagonHighlights(InCoords, InColor, FLinearColor::White);
+	}
+	for (AXkHexagonActor* HexagonActor : FindHexagonActors(InCoords))
+	{
+		HexagonActor->OnBaseHighlight(InColor);
+	}
+}
+
+
+void AXkHexagonalWorldActor::ClearHexagonHighlights()
+{
+	if (UXkHexagonalWorldComponent* HexagonalWorldComponent = FindComponentByClass<UXkHexagonalWorldComponent>())
+	{
+		HexagonalWorldComponent->ClearAllHexagonHighlights();
+	}
+	for (const TPair<FIntVector, TWeakObjectPtr<AXkHexagonActor>>& ActorPair : HexagonActorIndex)
+	{
+		if (AXkHexagonActor* HexagonActor = ActorPair.Value.Get())
+		{
+			HexagonActor->OnBaseHighlight();
+		}
+	}
+}
+
+
+#if WITH_EDITOR
+const FXkHexagonProcMeshData& AXkHexagonalWorldActor::GetHexagonProcMeshData() const
+{
+	const uint32 GeometryHash = GetHexagonGeometryHash();
+	if (HexagonProcMeshDataHash == GeometryHash)
+	{
+		return HexagonProcMeshData;
+	}
+	HexagonProcMeshDataHash = GeometryHash;
+
+	const FXkHexagonGeometryPtr Geometry = FXkHexagonGeometryCache::Get(GetHexagonGeometryKey());
+	FXkHexagonProcMeshData& Data = HexagonProcMeshData;
+	auto ConvertMesh = [this](const TArray<FVector4f>& InVertices, const TArray<uint32>& InIndices,
+		TArray<FVector>& OutVertices, TArray<int32>& OutIndices, TArray<FVector2D>& OutUV0s)
+		{
+			OutVertices.Reset(InVertices.Num());
+			OutUV0s.Reset(InVertices.Num());
+			for (const FVector4f& Vertex : InVertices)
+			{
+				const FVector Position(Vertex.X, Vertex.Y, Vertex.Z);
+				OutVertices.Add(Position);
+				OutUV0s.Add((FVector2D(Position.Y, -Position.X) + Radius) / (Radius * 2.0));
+			}
+			OutIndices.Reset(InIndices.Num());
+			for (const uint32 Index : InIndices)
+			{
+				OutIndices.Add((int32)Index);
+			}
+		};
+	ConvertMesh(Geometry->GetBaseVertices(), Geometry->GetBaseIndices(), Data.BaseVertices, Data.BaseIndices, Data.BaseUV0s);
+	ConvertMesh(Geometry->GetEdgeVertices(), Geometry->GetEdgeIndices(), Data.EdgeVertices, Data.EdgeIndices, Data.EdgeUV0s);
+	Data.Bounds = FBoxSphereBounds(Data.BaseVertices.GetData(), Data.BaseVertices.Num());
+	return Data;
+}
+#endif
+
+
+AXkHexagonActor* AXkHexagonalWorldActor::FindHexagonActor(const FIntVector& InCoord) const
+{
+	AXkHexagonActor* HexagonActor = HexagonActorIndex.FindRef(InCoord).Get();
+	return IsValid(HexagonActor) ? HexagonActor : nullptr;
+}
+
+
+TArray<AXkHexagonActor*> AXkHexagonalWorldActor::FindHexagonActors(const TArray<FIntVector>& InCoords) const
+{
+	TArray<AXkHexagonActor*> Results;
+	Results.Reserve(InCoords.Num());
+	for (const FIntVector& Coord : InCoords)
+	{
+		if (AXkHexagonActor* HexagonActor = FindHexagonActor(Coord))
+		{
+			Results.Add(HexagonActor);
+		}
+	}
+	return Results;
+}
+
+
+TArray<AXkHexagonActor*> AXkHexagonalWorldActor::GetHexagonActors() const
+{
+	TArray<AXkHexagonActor*> Results;
+	Results.Reserve(HexagonActorIndex.Num());
+	for (const TPair<FIntVector, TWeakObjectPtr<AXkHexagonActor>>& ActorPair : HexagonActorIndex)
+	{
+		AXkHexagonActor* HexagonActor = ActorPair.Value.Get();
+		if (IsValid(HexagonActor))
+		{
+			Results.Add(HexagonActor);
+		}
+	}
+	return Results;
+}
+
+
+void AXkHexagonalWorldActor::RegisterHexagonActor(AXkHexagonActor* InHexagonActor)
+{
+	HexagonActorIndex.Add(InHexagonActor->GetCoord(), InHexagonActor);
+}
+
+
+void AXkHexagonalWorldActor::UnregisterHexagonActor(const AXkHexagonActor* InHexagonActor)
+{
+	// Another actor may have taken the coord since.
+	const TWeakObjectPtr<AXkHexagonActor>* HexagonActor = HexagonActorIndex.Find(InHexagonActor->GetCoord());
+	if (HexagonActor && (!HexagonActor->IsValid() || HexagonActor->Get() == InHexagonActor))
+	{
+		HexagonActorIndex.Remove(InHexagonActor->GetCoord());
+	}
+}
+
+
 TArray<FXkHexagonNode*> AXkHexagonalWorldActor::GetHexagonNodeNeighbors(const FIntVector& InCoord) const
 {
 	TArray<FXkHexagonNode*> HexagonNodeNeighbors;
@@ -420,6 +604,7 @@ TArray<FXkHexagonNode*> AXkHexagonalWorldActor::GetHexagonNodesPath(const FIntVe
 	TArray<FXkHexagonNode*> FindingNodes;
 	TArray<FIntVector> FindingPaths;
 	HexagonAStarPathfinding.Reinit();
+	HexagonAStarPathfinding.Influencing(&HexagonInfluenceMap, PathfindingDangerCost);
 	if (HexagonAStarPathfinding.Pathfinding(StartCoord, EndCoord))
 	{
 		TArray<FIntVector> BacktrackingList = HexagonAStarPathfinding.Backtracking(BacktrackingMaxStep);
@@ -451,6 +636,7 @@ TArray<FXkHexagonNode*> AXkHexagonalWorldActor::GetHexagonNodesPathfinding(const
 		Blockers.Remove(EndCoord);
 	}
 	HexagonAStarPathfinding.Blocking(Blockers);
+	HexagonAStarPathfinding.Influencing(&HexagonInfluenceMap, PathfindingDangerCost);
 	if (HexagonAStarPathfinding.Pathfinding(StartCoord, EndCoord))
 	{
 		TArray<FIntVector> BacktrackingList = HexagonAStarPathfinding.Backtracking(BacktrackingMaxStep);
@@ -517,8 +703,7 @@ FVector2D AXkHexagonalWorldActor::GetFullUnscaledWorldSize(const FVector2D& Unsc
 
 void AXkHexagonalWorldActor::BuildHexagonData(TArray<FVector4f>& OutVertices, TArray<uint32>& OutIndices)
 {
-	TArray<FVector4f> EdgeVertices;
-	TArray<uint32> EdgeIndices;
-	BuildHexagon(OutVertices, OutIndices, EdgeVertices, EdgeIndices,
-		Radius, Height, BaseInnerGap, BaseOuterGap, EdgeInnerGap, EdgeOuterGap);
+	const FXkHexagonGeometryPtr Geometry = FXkHexagonGeometryCache::Get(GetHexagonGeometryKey());
+	OutVertices = Geometry->GetBaseVertices();
+	OutIndices = Geometry->GetBaseIndices();
 }
\ No newline at end of file
@@ -0,0 +1,210 @@
+// Copyright ©ICEPRINCE. All Rights Reserved.
+
+
+#include "XkHexagon/XkHexagonChunks.h"
+#include "Async/Async.h"
+
+
+FXkHexagonalWorldChunkStreamer::FXkHexagonalWorldChunkStreamer() :
+	HexagonalWorldTable(nullptr),
+	NextTicket(1)
+{
+}
+
+
+FXkHexagonalWorldChunkStreamer::~FXkHexagonalWorldChunkStreamer()
+{
+	Shutdown();
+}
+
+
+void FXkHexagonalWorldChunkStreamer::Initialize(FXkHexagonalWorldNodeTable* InTable, FChunkLoader&& InLoader)
+{
+	Shutdown();
+
+	check(InTable);
+	HexagonalWorldTable = InTable;
+	HexagonalWorldTable->Nodes.Empty();
+	HexagonalWorldTable->SetStreamingChunks(true);
+	HexagonalWorldTable->MarkAllNodesDirty();
+	ChunkLoader = MakeShared<FChunkLoader, ESPMode::ThreadSafe>(MoveTemp(InLoader));
+	ChunkResults = MakeShared<FChunkResultQueue, ESPMode::ThreadSafe>();
+}
+
+
+void FXkHexagonalWorldChunkStreamer::Shutdown()
+{
+	for (TPair<FIntPoint, FChunkLoad>& LoadPair : InFlightLoads)
+	{
+		LoadPair.Value.Future.Wait();
+	}
+	InFlightLoads.Empty();
+	for (TFuture<void>& Future : SupersededLoads)
+	{
+		Future.Wait();
+	}
+	SupersededLoads.Empty();
+	Chunks.Empty();
+	ChunkLoader.Reset();
+	ChunkResults.Reset();
+	HexagonalWorldTable = nullptr;
+}
+
+
+int32 FXkHexagonalWorldChunkStreamer::Update(const FIntVector& InCenterCoord, const int32 InLoadRadius, const int32 InUnloadRadius, const int32 InMaxAppliedChunks, TArray<FIntPoint>* OutChangedChunks)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FXkHexagonalWorldChunkStreamer::Update);
+
+	if (!IsStreaming())
+	{
+		return 0;
+	}
+
+	int32 ChangedChunkNum = 0;
+	const FIntPoint CenterKey = FXkHexagonalWorldNodeTable::GetChunkKey(InCenterCoord);
+	const int32 UnloadRadius = FMath::Max(InUnloadRadius, InLoadRadius);
+
+	// unload far away chunks first, the result of a loading chunk is dropped when it arrives
+	TArray<FIntPoint> FarChunkKeys;
+	for (const TPair<FIntPoint, FChunk>& ChunkPair : Chunks)
+	{
+		const FIntPoint Offset = ChunkPair.Key - CenterKey;
+		if (FMath::Max(FMath::Abs(Offset.X), FMath::Abs(Offset.Y)) > UnloadRadius)
+		{
+			FarChunkKeys.Add(ChunkPair.Key);
+		}
+	}
+	for (const FIntPoint& ChunkKey : FarChunkKeys)
+	{
+		FChunk& Chunk = Chunks[ChunkKey];
+		if (Chunk.State == EXkHexagonChunkState::Loaded)
+		{
+			ChangedChunkNum++;
+			if (OutChangedChunks)
+			{
+				OutChangedChunks->Add(ChunkKey);
+			}
+		}
+		UnloadChunk(ChunkKey, Chunk);
+		Chunks.Remove(ChunkKey);
+	}
+
+	// request near chunks, closer rings first
+	for (int32 Ring = 0; Ring <= InLoadRadius; Ring++)
+	{
+		for (int32 X = -Ring; X <= Ring; X++)
+		{
+			for (int32 Y = -Ring; Y <= Ring; Y++)
+			{
+				if (FMath::Max(FMath::Abs(X), FMath::Abs(Y)) != Ring)
+				{
+					continue;
+				}
+				RequestChunk(CenterKey + FIntPoint(X, Y));
+			}
+		}
+	}
+
+	// apply finished loads
+	FChunkResult Result;
+	int32 AppliedChunkNum = 0;
+	while (AppliedChunkNum < InMaxAppliedChunks && ChunkResults->Dequeue(Result))
+	{
+		const FChunkLoad* Load = InFlightLoads.Find(Result.ChunkKey);
+		if (Load && Load->Ticket == Result.Ticket)
+		{
+			InFlightLoads.Remove(Result.ChunkKey);
+		}
+		FChunk* Chunk = Chunks.Find(Result.ChunkKey);
+		if (!Chunk || Chunk->State != EXkHexagonChunkState::Loading || Chunk->Ticket != Result.Ticket)
+		{
+			continue;
+		}
+		for (const FXkHexagonNode& Node : Result.Nodes)
+		{
+			HexagonalWorldTable->Nodes.Add(Node.Coord, Node);
+			HexagonalWorldTable->MarkNodeDirty(Node.Coord, EXkHexagonNodeField::Added);
+		}
+		HexagonalWorldTable->SetChunkLoaded(Result.ChunkKey, true);
+		Chunk->State = EXkHexagonChunkState::Loaded;
+		AppliedChunkNum++;
+		if (OutChangedChunks)
+		{
+			OutChangedChunks->Add(Result.ChunkKey);
+		}
+	}
+	SupersededLoads.RemoveAll([](const TFuture<void>& Future) { return Future.IsReady(); });
+	return ChangedChunkNum + AppliedChunkNum;
+}
+
+
+void FXkHexagonalWorldChunkStreamer::RequestChunk(const FIntPoint& InChunkKey)
+{
+	if (!IsStreaming())
+	{
+		return;
+	}
+	FChunk& Chunk = Chunks.FindOrAdd(InChunkKey);
+	if (Chunk.State == EXkHexagonChunkState::Unloaded)
+	{
+		LoadChunk(InChunkKey, Chunk);
+	}
+}
+
+
+EXkHexagonChunkState FXkHexagonalWorldChunkStreamer::GetChunkState(const FIntPoint& InChunkKey) const
+{
+	const FChunk* Chunk = Chunks.Find(InChunkKey);
+	return Chunk ? Chunk->State : EXkHexagonChunkState::Unloaded;
+}
+
+
+void FXkHexagonalWorldChunkStreamer::LoadChunk(const FIntPoint& InChunkKey, FChunk& InChunk)
+{
+	InChunk.State = EXkHexagonChunkState::Loading;
+	InChunk.Ticket = NextTicket++;
+
+	// Previous load of an unloaded chunk may still run, its result is dropped by ticket and it is not waited for here.
+	if (FChunkLoad* PreviousLoad = InFlightLoads.Find(InChunkKey))
+	{
+		SupersededLoads.Add(MoveTemp(PreviousLoad->Future));
+	}
+
+	TSharedPtr<FChunkLoader, ESPMode::ThreadSafe> Loader = ChunkLoader;
+	TSharedPtr<FChunkResultQueue, ESPMode::ThreadSafe> Results = ChunkResults;
+	const uint32 Ticket = InChunk.Ticket;
+	FChunkLoad& Load = InFlightLoads.Add(InChunkKey);
+	Load.Ticket = Ticket;
+	Load.Future = Async(EAsyncExecution::ThreadPool, [Loader, Results, InChunkKey, Ticket]()
+		{
+			TRACE_CPUPROFILER_EVENT_SCOPE(FXkHexagonalWorldChunkStreamer::LoadChunk);
+			FChunkResult Result;
+			Result.ChunkKey = InChunkKey;
+			Result.Ticket = Ticket;
+			(*Loader)(InChunkKey, Result.Nodes);
+			Results->Enqueue(MoveTemp(Result));
+		});
+}
+
+
+void FXkHexagonalWorldChunkStreamer::UnloadChunk(const FIntPoint& InChunkKey, FChunk& InChunk)
+{
+	if (InChunk.State == EXkHexagonChunkState::Loaded)
+	{
+		const FIntPoint Origin = FIntPoint(InChunkKey.X << HEXAGON_CHUNK_SHIFT, InChunkKey.Y << HEXAGON_CHUNK_SHIFT);
+		for (int32 X = Origin.X; X < Origin.X + HEXAGON_CHUNK_SIZE; X++)
+		{
+			for (int32 Y = Origin.Y; Y < Origin.Y + HEXAGON_CHUNK_SIZE; Y++)
+			{
+				const FIntVector Coord = FIntVector(X, Y, -X - Y);
+				if (HexagonalWorldTable->Nodes.Remove(Coord) > 0)
+				{
+					HexagonalWorldTable->MarkNodeDirty(Coord, EXkHexagonNodeField::Removed);
+				}
+			}
+		}
+		HexagonalWorldTable->SetChunkLoaded(InChunkKey, false);
+	}
+	InChunk.State = EXkHexagonChunkState::Unloaded;
+	InChunk.Ticket = 0;
+}
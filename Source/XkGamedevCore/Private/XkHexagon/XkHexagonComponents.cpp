@@ -476,6 +476,35 @@ UXkHexagonalWorldComponent::UXkHexagonalWorldComponent(const FObjectInitializer&
 
 	bShowBaseMesh = false;
 	bShowEdgeMesh = true;
+
+	HexagonalWorldTable = nullptr;
+	ChangeJournalHandle = INDEX_NONE;
+	bRenderVisibilityDirty = false;
+}
+
+
+void UXkHexagonalWorldComponent::InitHexagonalWorldTable(FXkHexagonalWorldNodeTable* Input)
+{
+	if (HexagonalWorldTable && ChangeJournalHandle != INDEX_NONE)
+	{
+		HexagonalWorldTable->GetChangeJournal().Unsubscribe(ChangeJournalHandle);
+	}
+	HexagonalWorldTable = Input;
+	ChangeJournalHandle = HexagonalWorldTable ? HexagonalWorldTable->GetChangeJournal().Subscribe() : INDEX_NONE;
+	// Changes before the subscription are not in the journal, the proxy is made again from the whole table.
+	MarkRenderStateDirty();
+}
+
+
+void UXkHexagonalWorldComponent::OnComponentDestroyed(bool bDestroyingHierarchy)
+{
+	if (HexagonalWorldTable && ChangeJournalHandle != INDEX_NONE)
+	{
+		HexagonalWorldTable->GetChangeJournal().Unsubscribe(ChangeJournalHandle);
+	}
+	ChangeJournalHandle = INDEX_NONE;
+	HexagonalWorldTable = nullptr;
+	Super::OnComponentDestroyed(bDestroyingHierarchy);
 }
 
 
@@ -487,6 +516,15 @@ void UXkHexagonalWorldComponent::PostLoad()
 
 FPrimitiveSceneProxy* UXkHexagonalWorldComponent::CreateSceneProxy()
 {
+	// The new proxy starts from the whole snapshot, the journal changes up to it are dropped.
+	TArray<FXkHexagonNodeChange> NodeChanges;
+	ConsumeNodeChanges(NodeChanges);
+	// The new proxy copies every shown highlight and the visibility, updates for the old one are dropped with its channel.
+	TArray<FXkHexagonHighlightChange> HighlightChanges;
+	ResolveHexagonHighlights(HighlightChanges);
+	bRenderVisibilityDirty = false;
+	ResetPendingRenderUpdate();
+	RenderChannel = MakeShared<FXkHexagonalWorldRenderChannel, ESPMode::ThreadSafe>(64);
 	FPrimitiveSceneProxy* HexagonalWorldceneProxy = NULL;
 	if (BaseMaterial && EdgeMaterial)
 	{
@@ -510,38 +548,169 @@ FBoxSphereBounds UXkHexagonalWorldComponent::CalcBounds(const FTransform& LocalT
 void UXkHexagonalWorldComponent::TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
 {
 	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	// Every change of the tick goes in one update, with only the coords whose shown highlight changed.
+	FXkHexagonalWorldRenderUpdate Update;
+	if (DirtyHighlightCoords.Num() > 0)
+	{
+		ResolveHexagonHighlights(Update.HighlightChanges);
+	}
+	if (bRenderVisibilityDirty)
+	{
+		bRenderVisibilityDirty = false;
+		Update.bVisibilityChanged = true;
+		Update.bShowBaseMesh = bShowBaseMesh;
+		Update.bShowEdgeMesh = bShowEdgeMesh;
+	}
+	if (HexagonalWorldTable)
+	{
+		// Hand the render thread an immutable copy, it never reads the live node table.
+		const FXkHexagonalWorldSnapshotPtr PreviousSnapshot = HexagonalWorldSnapshot;
+		const bool bIncremental = ConsumeNodeChanges(Update.NodeChanges);
+		if (HexagonalWorldSnapshot != PreviousSnapshot)
+		{
+			Update.Snapshot = HexagonalWorldSnapshot;
+			Update.bFullSync = !bIncremental;
+		}
+	}
+	if (Update.HasChanges())
+	{
+		MergePendingRenderUpdate(MoveTemp(Update));
+	}
+	FlushRenderUpdates();
 }
 
 
-FMaterialRelevance UXkHexagonalWorldComponent::GetMaterialRelevance(ERHIFeatureLevel::Type InFeatureLevel) const
+bool UXkHexagonalWorldComponent::ConsumeNodeChanges(TArray<FXkHexagonNodeChange>& OutChanges)
 {
-	FMaterialRelevance Result;
-	Result |= BaseMaterial->GetRelevance_Concurrent(InFeatureLevel);
-	Result |= EdgeMaterial->GetRelevance_Concurrent(InFeatureLevel);
-	return Result;
+	OutChanges.Reset();
+	if (!HexagonalWorldTable)
+	{
+		return false;
+	}
+	// Publishing closes the journal frame, the consumed changes are exactly the ones between the two snapshots.
+	HexagonalWorldSnapshot = HexagonalWorldTable->PublishSnapshot();
+	return ChangeJournalHandle != INDEX_NONE && HexagonalWorldTable->GetChangeJournal().Consume(ChangeJournalHandle, OutChanges);
 }
 
 
-void UXkHexagonalWorldComponent::GetUsedMaterials(TArray<UMaterialInterface*>& OutMaterials, bool bGetDebugMaterials) const
+void UXkHexagonalWorldComponent::FlushRenderUpdates()
 {
-	if (BaseMaterial && EdgeMaterial)
+	// Without a proxy there is no one to drain them, the next proxy copies the state of the component.
+	if (!SceneProxy || !RenderChannel.IsValid())
 	{
-		OutMaterials.Add(BaseMaterial);
-		OutMaterials.Add(EdgeMaterial);
+		ResetPendingRenderUpdate();
+		return;
+	}
+	// A full ring leaves the update untouched, the next ticks merge into it.
+	if (PendingRenderUpdate.HasChanges() && RenderChannel->Enqueue(MoveTemp(PendingRenderUpdate)))
+	{
+		ResetPendingRenderUpdate();
 	}
 }
 
 
-void UXkHexagonalWorldComponent::BuildHexagonData(TArray<FVector4f>& OutVertices, TArray<uint32>& OutIndices)
+void UXkHexagonalWorldComponent::MergePendingRenderUpdate(FXkHexagonalWorldRenderUpdate&& InUpdate)
 {
-	if (FXkHexagonalWorldSceneProxy* HexagonalWorldSceneProxy = static_cast<FXkHexagonalWorldSceneProxy*>(SceneProxy))
+	TRACE_CPUPROFILER_EVENT_SCOPE(UXkHexagonalWorldComponent::MergePendingRenderUpdate);
+
+	if (!PendingRenderUpdate.HasChanges())
 	{
-		OutVertices = HexagonalWorldSceneProxy->HexagonData.BaseVertices;
-		OutIndices = HexagonalWorldSceneProxy->HexagonData.BaseIndices;
+		PendingRenderUpdate = MoveTemp(InUpdate);
+		return;
+	}
+	// Index the pending changes once, only ticks that find the ring full pay for it.
+	if (PendingNodeChangeIndices.Num() == 0)
+	{
+		for (int32 Index = 0; Index < PendingRenderUpdate.NodeChanges.Num(); Index++)
+		{
+			PendingNodeChangeIndices.Add(PendingRenderUpdate.NodeChanges[Index].Coord, Index);
+		}
+	}
+	if (PendingHighlightChangeIndices.Num() == 0)
+	{
+		for (int32 Index = 0; Index < PendingRenderUpdate.HighlightChanges.Num(); Index++)
+		{
+			PendingHighlightChangeIndices.Add(PendingRenderUpdate.HighlightChanges[Index].Coord, Index);
+		}
+	}
+
+	if (InUpdate.Snapshot.IsValid())
+	{
+		// The proxy looks every changed node up in the latest snapshot, the changed fields of a coord add up.
+		PendingRenderUpdate.Snapshot = InUpdate.Snapshot;
+		PendingRenderUpdate.bFullSync |= InUpdate.bFullSync;
+		if (PendingRenderUpdate.bFullSync)
+		{
+			PendingRenderUpdate.NodeChanges.Empty();
+			PendingNodeChangeIndices.Empty();
+		}
+		else
+		{
+			for (const FXkHexagonNodeChange& Change : InUpdate.NodeChanges)
+			{
+				if (const int32* Index = PendingNodeChangeIndices.Find(Change.Coord))
+				{
+					PendingRenderUpdate.NodeChanges[*Index].Fields |= Change.Fields;
+				}
+				else
+				{
+					PendingNodeChangeIndices.Add(Change.Coord, PendingRenderUpdate.NodeChanges.Add(Change));
+				}
+			}
+		}
+	}
+	// A highlight change carries the whole shown highlight of the coord, the later one wins.
+	for (const FXkHexagonHighlightChange& Change : InUpdate.HighlightChanges)
+	{
+		if (const int32* Index = PendingHighlightChangeIndices.Find(Change.Coord))
+		{
+			PendingRenderUpdate.HighlightChanges[*Index] = Change;
+		}
+		else
+		{
+			PendingHighlightChangeIndices.Add(Change.Coord, PendingRenderUpdate.HighlightChanges.Add(Change));
+		}
+	}
+	if (InUpdate.bVisibilityChanged)
+	{
+		PendingRenderUpdate.bVisibilityChanged = true;
+		PendingRenderUpdate.bShowBaseMesh = InUpdate.bShowBaseMesh;
+		PendingRenderUpdate.bShowEdgeMesh = InUpdate.bShowEdgeMesh;
 	}
 }
 
 
+void UXkHexagonalWorldComponent::ResetPendingRenderUpdate()
+{
+	PendingRenderUpdate = FXkHexagonalWorldRenderUpdate();
+	PendingNodeChangeIndices.Reset();
+	PendingHighlightChangeIndices.Reset();
+}
+
+
+void UXkHexagonalWorldComponent::SetShowBaseMesh(const bool bInShow)
+{
+	bRenderVisibilityDirty |= bShowBaseMesh != bInShow;
+	bShowBaseMesh = bInShow;
+}
+
+
+void UXkHexagonalWorldComponent::SetShowEdgeMesh(const bool bInShow)
+{
+	bRenderVisibilityDirty |= bShowEdgeMesh != bInShow;
+	bShowEdgeMesh = bInShow;
+}
+
+
+void UXkHexagonalWorldComponent::BuildHexagonData(TArray<FVector4f>& OutVertices, TArray<uint32>& OutIndices)
+{
+	const FXkHexagonGeometryPtr Geometry = FXkHexagonGeometryCache::Get(GetHexagonGeometryKey());
+	OutVertices = Geometry->GetBaseVertices();
+	OutIndices = Geometry->GetBaseIndices();
+}
+
+
 FVector2D UXkHexagonalWorldComponent::GetHexagonalWorldExtent() const
 {
 	float Distance = Radius + GapWidth;
@@ -560,6 +729,126 @@ FVector2D UXkHexagonalWorldComponent::GetFullUnscaledWorldSize(const FVector2D&
 }
 
 
+void UXkHexagonalWorldComponent::SetHexagonHighlights(const TArray<FIntVector>& InCoords, const FLinearColor& InBaseColor, const FLinearColor& InEdgeColor)
+{
+	const FXkHexagonHighlightLayer* Layer = HighlightLayers.Find(NAME_None);
+	SetHexagonLayerHighlights(NAME_None, Layer ? Layer->Priority : 0, InCoords, InBaseColor, InEdgeColor);
+}
+
+
+void UXkHexagonalWorldComponent::ClearHexagonHighlights(const TArray<FIntVector>& InCoords)
+{
+	ClearHexagonLayerHighlights(NAME_None, InCoords);
+}
+
+
+void UXkHexagonalWorldComponent::ClearAllHexagonHighlights()
+{
+	for (const TPair<FName, FXkHexagonHighlightLayer>& LayerPair : HighlightLayers)
+	{
+		for (const TPair<FIntVector, FXkHexagonHighlight>& HighlightPair : LayerPair.Value.Highlights)
+		{
+			DirtyHighlightCoords.Add(HighlightPair.Key);
+		}
+	}
+	HighlightLayers.Empty();
+}
+
+
+void UXkHexagonalWorldComponent::SetHexagonLayerHighlights(const FName InLayer, const int32 InPriority, const TArray<FIntVector>& InCoords, const FLinearColor& InBaseColor, const FLinearColor& InEdgeColor)
+{
+	FXkHexagonHighlightLayer& Layer = HighlightLayers.FindOrAdd(InLayer);
+	if (Layer.Priority != InPriority)
+	{
+		// Another priority may change what shows on every coord of the layer.
+		Layer.Priority = InPriority;
+		for (const TPair<FIntVector, FXkHexagonHighlight>& HighlightPair : Layer.Highlights)
+		{
+			DirtyHighlightCoords.Add(HighlightPair.Key);
+		}
+	}
+	const FXkHexagonHighlight Highlight(InBaseColor, InEdgeColor);
+	for (const FIntVector& Coord : InCoords)
+	{
+		Layer.Highlights.Add(Coord, Highlight);
+		DirtyHighlightCoords.Add(Coord);
+	}
+}
+
+
+void UXkHexagonalWorldComponent::ClearHexagonLayerHighlights(const FName InLayer, const TArray<FIntVector>& InCoords)
+{
+	FXkHexagonHighlightLayer* Layer = HighlightLayers.Find(InLayer);
+	if (!Layer)
+	{
+		return;
+	}
+	for (const FIntVector& Coord : InCoords)
+	{
+		if (Layer->Highlights.Remove(Coord) > 0)
+		{
+			DirtyHighlightCoords.Add(Coord);
+		}
+	}
+	if (Layer->Highlights.Num() == 0)
+	{
+		HighlightLayers.Remove(InLayer);
+	}
+}
+
+
+void UXkHexagonalWorldComponent::ClearHexagonHighlightLayer(const FName InLayer)
+{
+	FXkHexagonHighlightLayer Layer;
+	if (HighlightLayers.RemoveAndCopyValue(InLayer, Layer))
+	{
+		for (const TPair<FIntVector, FXkHexagonHighlight>& HighlightPair : Layer.Highlights)
+		{
+			DirtyHighlightCoords.Add(HighlightPair.Key);
+		}
+	}
+}
+
+
+void UXkHexagonalWorldComponent::ResolveHexagonHighlights(TArray<FXkHexagonHighlightChange>& OutChanges)
+{
+	OutChanges.Reserve(OutChanges.Num() + DirtyHighlightCoords.Num());
+	for (const FIntVector& Coord : DirtyHighlightCoords)
+	{
+		// A few layers at most, each coord looks through all of them.
+		// Equal priorities are decided by the layer name, the map order changes as layers come and go.
+		const FXkHexagonHighlight* ShownHighlight = nullptr;
+		int32 ShownPriority = 0;
+		FName ShownLayer;
+		for (const TPair<FName, FXkHexagonHighlightLayer>& LayerPair : HighlightLayers)
+		{
+			const FXkHexagonHighlight* Highlight = LayerPair.Value.Highlights.Find(Coord);
+			if (Highlight && (!ShownHighlight || LayerPair.Value.Priority > ShownPriority
+				|| (LayerPair.Value.Priority == ShownPriority && LayerPair.Key.Compare(ShownLayer) < 0)))
+			{
+				ShownHighlight = Highlight;
+				ShownPriority = LayerPair.Value.Priority;
+				ShownLayer = LayerPair.Key;
+			}
+		}
+		if (ShownHighlight)
+		{
+			const FXkHexagonHighlight* OldHighlight = HexagonHighlights.Find(Coord);
+			if (!OldHighlight || *OldHighlight != *ShownHighlight)
+			{
+				HexagonHighlights.Add(Coord, *ShownHighlight);
+				OutChanges.Add(FXkHexagonHighlightChange(Coord, *ShownHighlight));
+			}
+		}
+		else if (HexagonHighlights.Remove(Coord) > 0)
+		{
+			OutChanges.Add(FXkHexagonHighlightChange(Coord));
+		}
+	}
+	DirtyHighlightCoords.Reset();
+}
+
+
 UXkInstancedHexagonComponent::UXkInstancedHexagonComponent(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
 {
@@ -0,0 +1,131 @@
+// Copyright ©ICEPRINCE. All Rights Reserved.
+
+
+#include "XkHexagon/XkHexagonGenerateCache.h"
+#include "XkHexagon/XkHexagonWorldFile.h"
+#include "XkGamedevCore.h"
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+#include "Misc/SecureHash.h"
+
+
+FXkHexagonalWorldGenerateCache::FXkHexagonalWorldGenerateCache(const FString& InDirectory, const int32 InMaxEntryNum) :
+	Directory(InDirectory.IsEmpty() ? GetDefaultDirectory() : InDirectory),
+	MaxEntryNum(FMath::Max(InMaxEntryNum, 1))
+{
+}
+
+
+FString FXkHexagonalWorldGenerateCache::GetDefaultDirectory()
+{
+	return FPaths::ConvertRelativePathToFull(FPaths::ProjectSavedDir() / TEXT("XkHexagonalWorldCache"));
+}
+
+
+FString FXkHexagonalWorldGenerateCache::MakeKey(const FXkHexagonalWorldGenerateSettings& InSettings, const TArray<uint8>& InExtraInputs)
+{
+	FSHA1 Sha;
+	const uint32 FileVersion = HEXAGON_WORLD_FILE_VERSION;
+	Sha.Update((const uint8*)&FileVersion, sizeof(FileVersion));
+	const uint32 GeneratorVersion = HEXAGON_GENERATOR_VERSION;
+	Sha.Update((const uint8*)&GeneratorVersion, sizeof(GeneratorVersion));
+	Sha.Update((const uint8*)&InSettings.Radius, sizeof(InSettings.Radius));
+	Sha.Update((const uint8*)&InSettings.GapWidth, sizeof(InSettings.GapWidth));
+	Sha.Update((const uint8*)&InSettings.GroundManhattanDistance, sizeof(InSettings.GroundManhattanDistance));
+	Sha.Update((const uint8*)&InSettings.ShorelineManhattanDistance, sizeof(InSettings.ShorelineManhattanDistance));
+	Sha.Update((const uint8*)&InSettings.WorldSeed, sizeof(InSettings.WorldSeed));
+	Sha.Update((const uint8*)&InSettings.HeightNoiseSize, sizeof(InSettings.HeightNoiseSize));
+	const int32 SplatNum = InSettings.HexagonSplats.Num();
+	Sha.Update((const uint8*)&SplatNum, sizeof(SplatNum));
+	for (const FXkHexagonSplat& HexagonSplat : InSettings.HexagonSplats)
+	{
+		const uint8 TargetType = (uint8)HexagonSplat.TargetType;
+		const int32 SplatIdNum = HexagonSplat.Splats.Num();
+		Sha.Update(&TargetType, sizeof(TargetType));
+		Sha.Update((const uint8*)&HexagonSplat.Height, sizeof(HexagonSplat.Height));
+		Sha.Update((const uint8*)&HexagonSplat.NoiseHeight, sizeof(HexagonSplat.NoiseHeight));
+		Sha.Update((const uint8*)&SplatIdNum, sizeof(SplatIdNum));
+		Sha.Update(HexagonSplat.Splats.GetData(), SplatIdNum);
+	}
+	Sha.Update(InExtraInputs.GetData(), InExtraInputs.Num());
+	Sha.Final();
+
+	uint8 Hash[FSHA1::DigestSize];
+	Sha.GetHash(Hash);
+	return BytesToHex(Hash, FSHA1::DigestSize);
+}
+
+
+FString FXkHexagonalWorldGenerateCache::GetFilename(const FString& InKey) const
+{
+	return Directory / (InKey + TEXT(".") + HEXAGON_WORLD_FILE_EXTENSION);
+}
+
+
+bool FXkHexagonalWorldGenerateCache::Load(const FString& InKey, const FXkHexagonalWorldGenerateSettings& InSettings, FXkHexagonalWorldGrid& OutGrid) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FXkHexagonalWorldGenerateCache::Load);
+
+	const FString Filename = GetFilename(InKey);
+	FXkHexagonalWorldFile WorldFile;
+	if (!IFileManager::Get().FileExists(*Filename) || !WorldFile.Open(Filename))
+	{
+		return false;
+	}
+	WorldFile.FillGrid(OutGrid);
+	OutGrid.GeneratedSettings = InSettings;
+	WorldFile.Close();
+
+	// Keep the entries in least recently used order.
+	IFileManager::Get().SetTimeStamp(*Filename, FDateTime::UtcNow());
+	return true;
+}
+
+
+bool FXkHexagonalWorldGenerateCache::Save(const FString& InKey, const FXkHexagonalWorldGrid& InGrid) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FXkHexagonalWorldGenerateCache::Save);
+
+	if (InGrid.Pitch == 0 || InGrid.CompletedStageNum != (int32)EXkHexagonGenerateStage::Num)
+	{
+		return false;
+	}
+	// Readers never see a partial entry, the file only appears under its key once written.
+	const FString Filename = GetFilename(InKey);
+	const FString TempFilename = FPaths::CreateTempFilename(*Directory, *InKey, TEXT(".tmp"));
+	IFileManager::Get().MakeDirectory(*Directory, true);
+	if (!FXkHexagonalWorldFile::Save(TempFilename, InGrid))
+	{
+		return false;
+	}
+	if (!IFileManager::Get().Move(*Filename, *TempFilename, true, true))
+	{
+		IFileManager::Get().Delete(*TempFilename);
+		return false;
+	}
+	Prune();
+	return true;
+}
+
+
+void FXkHexagonalWorldGenerateCache::Prune() const
+{
+	TArray<FString> Filenames;
+	IFileManager::Get().FindFiles(Filenames, *(Directory / (FString(TEXT("*.")) + HEXAGON_WORLD_FILE_EXTENSION)), true, false);
+	if (Filenames.Num() <= MaxEntryNum)
+	{
+		return;
+	}
+
+	TArray<TPair<FDateTime, FString>> Entries;
+	for (const FString& Filename : Filenames)
+	{
+		const FString FullFilename = Directory / Filename;
+		Entries.Add(TPair<FDateTime, FString>(IFileManager::Get().GetTimeStamp(*FullFilename), FullFilename));
+	}
+	Entries.Sort([](const TPair<FDateTime, FString>& A, const TPair<FDateTime, FString>& B) { return A.Key > B.Key; });
+	for (int32 Index = MaxEntryNum; Index < Entries.Num(); Index++)
+	{
+		IFileManager::Get().Delete(*Entries[Index].Value, false, false, true);
+	}
+}
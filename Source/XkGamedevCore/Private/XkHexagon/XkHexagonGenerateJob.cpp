@@ -0,0 +1,132 @@
+// Copyright ©ICEPRINCE. All Rights Reserved.
+
+
+#include "XkHexagon/XkHexagonGenerateJob.h"
+#include "XkHexagon/XkHexagonGenerateCache.h"
+#include "Async/Async.h"
+
+
+FXkHexagonalWorldGenerateJob::FXkHexagonalWorldGenerateJob()
+{
+}
+
+
+FXkHexagonalWorldGenerateJob::~FXkHexagonalWorldGenerateJob()
+{
+	Cancel();
+}
+
+
+void FXkHexagonalWorldGenerateJob::Start(const FXkHexagonalWorldGenerateSettings& InSettings, const FString& InCacheKey)
+{
+	Cancel();
+
+	FStatePtr NewState = MakeShared<FState, ESPMode::ThreadSafe>();
+	State = NewState;
+	Future = Async(EAsyncExecution::ThreadPool, [InSettings, InCacheKey, NewState]()
+		{
+			Run(InSettings, InCacheKey, NewState);
+		});
+}
+
+
+void FXkHexagonalWorldGenerateJob::Cancel()
+{
+	// The worker owns a reference to its state, dropping ours is enough.
+	if (State.IsValid())
+	{
+		State->bCancelled = true;
+	}
+	State.Reset();
+	Future = TFuture<void>();
+}
+
+
+float FXkHexagonalWorldGenerateJob::GetProgress() const
+{
+	if (!State.IsValid())
+	{
+		return 1.0f;
+	}
+	return FMath::Clamp((float)State->CompletedSteps / (float)StepNum, 0.0f, 1.0f);
+}
+
+
+FXkHexagonalWorldGenerateResultPtr FXkHexagonalWorldGenerateJob::TakeResult()
+{
+	if (!IsReady())
+	{
+		return nullptr;
+	}
+	FXkHexagonalWorldGenerateResultPtr Result = State->Result;
+	State.Reset();
+	Future = TFuture<void>();
+	return Result;
+}
+
+
+void FXkHexagonalWorldGenerateJob::BuildCanvasInstances(const TMap<FIntVector, FXkHexagonNode>& InNodes, TArray<FVector4f>& OutPositions, TArray<FVector4f>& OutWeights, const FBox2D* InBounds)
+{
+	OutPositions.Reset(InBounds ? 0 : InNodes.Num());
+	OutWeights.Reset(InBounds ? 0 : InNodes.Num());
+	for (const TPair<FIntVector, FXkHexagonNode>& NodePair : InNodes)
+	{
+		const FXkHexagonNode& Node = NodePair.Value;
+		if (InBounds && !InBounds->IsInside(FVector2D(Node.Position.X, Node.Position.Y)))
+		{
+			continue;
+		}
+		OutPositions.Add(Node.Position);
+		OutWeights.Add(FVector4f(FVector3f(1.0), (float)Node.Splatmap / 255.0f));
+	}
+}
+
+
+void FXkHexagonalWorldGenerateJob::Run(const FXkHexagonalWorldGenerateSettings& InSettings, const FString& InCacheKey, const FStatePtr& InState)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FXkHexagonalWorldGenerateJob::Run);
+
+	FXkHexagonalWorldGenerateResultPtr Result = MakeShared<FXkHexagonalWorldGenerateResult, ESPMode::ThreadSafe>();
+	const FXkHexagonalWorldGenerateCache GenerateCache;
+	if (!InCacheKey.IsEmpty() && GenerateCache.Load(InCacheKey, InSettings, Result->Grid))
+	{
+		Result->bFromCache = true;
+		Result->Stats.NodeNum = Result->Grid.NodeCells.Num();
+		InState->CompletedSteps += (int32)EXkHexagonGenerateStage::Num;
+	}
+	else
+	{
+		const FXkHexagonalWorldGenerator Generator(InSettings);
+		for (int32 StageIndex = 0; StageIndex < (int32)EXkHexagonGenerateStage::Num; StageIndex++)
+		{
+			if (InState->bCancelled)
+			{
+				return;
+			}
+			const EXkHexagonGenerateStage Stage = (EXkHexagonGenerateStage)StageIndex;
+			Generator.Generate(Result->Grid, &Result->Stats, Stage, Stage);
+			InState->CompletedSteps++;
+		}
+		if (!InCacheKey.IsEmpty() && !InState->bCancelled)
+		{
+			GenerateCache.Save(InCacheKey, Result->Grid);
+		}
+	}
+
+	if (InState->bCancelled)
+	{
+		return;
+	}
+	Result->Grid.FillNodes(Result->Nodes);
+	InState->CompletedSteps++;
+
+	if (InState->bCancelled)
+	{
+		return;
+	}
+	BuildCanvasInstances(Result->Nodes, Result->InstancePositions, Result->InstanceWeights);
+	InState->CompletedSteps++;
+
+	InState->Result = Result;
+	InState->bFinished = true;
+}
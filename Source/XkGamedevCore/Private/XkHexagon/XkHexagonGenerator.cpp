@@ -0,0 +1,462 @@
+// Copyright ©ICEPRINCE. All Rights Reserved.
+
+
+#include "XkHexagon/XkHexagonGenerator.h"
+#include "XkHexagon/XkHexagonRandom.h"
+#include "XkLandscape/XkNoiseFBM.h"
+#include "Async/ParallelFor.h"
+
+
+static FORCEINLINE FVector2f GetHeightNoiseST(const float InHeightNoiseSize, const FVector4f& InPosition)
+{
+	// OutputFBM(world_pos, size) of XkNoiseFBM.ush, uv = world_pos / size and FBMSimulate(uv * 3)
+	return FVector2f(InPosition.X, InPosition.Y) / InHeightNoiseSize * 3.0f;
+}
+
+
+bool FXkHexagonalWorldGenerateSettings::GenerateNode(const FIntVector& InCoord, FXkHexagonNode& OutNode) const
+{
+	uint8 Type = 0;
+	FVector4f Position;
+	if (!FXkHexagonalWorldGenerator::LayoutCell(*this, InCoord, Type, Position))
+	{
+		return false;
+	}
+	Type = FXkHexagonalWorldGenerator::ClassifyCell(*this, InCoord);
+	uint8 Splat = 0;
+	const float HeightNoise = FXkHexagonalWorldGenerator::HeightNoiseCell(*this, Position);
+	FXkHexagonalWorldGenerator::HeightSplatCell(*this, Type, FXkHexagonRandom::Random(WorldSeed, InCoord, HEXAGON_RANDOM_STREAM_SPLAT), HeightNoise, Position, Splat);
+	OutNode = FXkHexagonNode((EXkHexagonType)Type, Position, Splat, InCoord);
+	return true;
+}
+
+
+void FXkHexagonalWorldGrid::Allocate(const int32 InMaxManhattanDistance)
+{
+	MaxManhattanDistance = FMath::Max(InMaxManhattanDistance, 0);
+	Pitch = MaxManhattanDistance * 2 + 1;
+	const int32 CellNum = Pitch * Pitch;
+	Types.Reset();
+	Types.SetNumZeroed(CellNum);
+	Splats.Reset();
+	Splats.SetNumZeroed(CellNum);
+	Positions.Reset();
+	Positions.SetNumZeroed(CellNum);
+	CustomData.Reset();
+	CustomData.SetNumZeroed(CellNum);
+	NodeCells.Reset();
+	CompletedStageNum = 0;
+}
+
+
+void FXkHexagonalWorldGrid::Resize(const int32 InMaxManhattanDistance)
+{
+	if (InMaxManhattanDistance == MaxManhattanDistance)
+	{
+		return;
+	}
+	FXkHexagonalWorldGrid OldGrid = MoveTemp(*this);
+	const int32 OldCompletedStageNum = OldGrid.CompletedStageNum;
+	Allocate(InMaxManhattanDistance);
+	GeneratedSettings = OldGrid.GeneratedSettings;
+	CompletedStageNum = OldCompletedStageNum;
+
+	const int32 R = FMath::Min(MaxManhattanDistance, OldGrid.MaxManhattanDistance);
+	for (int32 X = -R; X <= R; X++)
+	{
+		for (int32 Y = -R; Y <= R; Y++)
+		{
+			const int32 OldCellIndex = OldGrid.GetCellIndex(X, Y);
+			const int32 CellIndex = GetCellIndex(X, Y);
+			Types[CellIndex] = OldGrid.Types[OldCellIndex];
+			Splats[CellIndex] = OldGrid.Splats[OldCellIndex];
+			Positions[CellIndex] = OldGrid.Positions[OldCellIndex];
+			CustomData[CellIndex] = OldGrid.CustomData[OldCellIndex];
+		}
+	}
+}
+
+
+FXkHexagonNode FXkHexagonalWorldGrid::MakeNode(const int32 InCellIndex) const
+{
+	FXkHexagonNode Node = FXkHexagonNode((EXkHexagonType)Types[InCellIndex], Positions[InCellIndex], Splats[InCellIndex], GetCoord(InCellIndex));
+	Node.CustomData = CustomData[InCellIndex];
+	return Node;
+}
+
+
+void FXkHexagonalWorldGrid::FillNodes(TMap<FIntVector, FXkHexagonNode>& OutNodes) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FXkHexagonalWorldGrid::FillNodes);
+
+	OutNodes.Empty(NodeCells.Num());
+	for (const int32 CellIndex : NodeCells)
+	{
+		OutNodes.Add(GetCoord(CellIndex), MakeNode(CellIndex));
+	}
+}
+
+
+FXkHexagonalWorldGenerator::FXkHexagonalWorldGenerator(const FXkHexagonalWorldGenerateSettings& InSettings) :
+	Settings(InSettings)
+{
+}
+
+
+void FXkHexagonalWorldGenerator::Generate(FXkHexagonalWorldGrid& OutGrid, FXkHexagonGenerateStats* OutStats,
+	const EXkHexagonGenerateStage InFirstStage, const EXkHexagonGenerateStage InLastStage) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FXkHexagonalWorldGenerator::Generate);
+
+	for (int32 StageIndex = (int32)InFirstStage; StageIndex <= (int32)InLastStage; StageIndex++)
+	{
+		const double StartSeconds = FPlatformTime::Seconds();
+		RunStage((EXkHexagonGenerateStage)StageIndex, OutGrid);
+		if (OutStats)
+		{
+			OutStats->StageSeconds[StageIndex] = FPlatformTime::Seconds() - StartSeconds;
+		}
+		// Stages out of order leave the grid incomplete.
+		OutGrid.CompletedStageNum = (OutGrid.CompletedStageNum == StageIndex) ? StageIndex + 1 : FMath::Min(OutGrid.CompletedStageNum, StageIndex);
+	}
+	OutGrid.GeneratedSettings = Settings;
+	if (OutStats)
+	{
+		OutStats->NodeNum = OutGrid.NodeCells.Num();
+	}
+}
+
+
+void FXkHexagonalWorldGenerator::RunStage(const EXkHexagonGenerateStage InStage, FXkHexagonalWorldGrid& InOutGrid, const FXkHexagonGenerateBand& InBand) const
+{
+	switch (InStage)
+	{
+	case EXkHexagonGenerateStage::Layout: RunLayout(InOutGrid, InBand); break;
+	case EXkHexagonGenerateStage::Classification: RunClassification(InOutGrid, InBand); break;
+	case EXkHexagonGenerateStage::HeightSplat: RunHeightSplat(InOutGrid, InBand); break;
+	case EXkHexagonGenerateStage::PostProcess: RunPostProcess(InOutGrid); break;
+	default: break;
+	}
+}
+
+
+bool FXkHexagonalWorldGenerator::Regenerate(FXkHexagonalWorldGrid& InOutGrid, TArray<FIntVector>& OutChangedCoords, FXkHexagonGenerateStats* OutStats) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FXkHexagonalWorldGenerator::Regenerate);
+
+	OutChangedCoords.Reset();
+	const FXkHexagonalWorldGenerateSettings& OldSettings = InOutGrid.GeneratedSettings;
+	const bool bReusable = InOutGrid.Pitch > 0 && InOutGrid.CompletedStageNum == (int32)EXkHexagonGenerateStage::Num
+		&& GetStageHash(OldSettings, EXkHexagonGenerateStage::Layout) == GetStageHash(Settings, EXkHexagonGenerateStage::Layout);
+	if (!bReusable)
+	{
+		// Every old node moved, the caller should rebuild instead of patching.
+		Generate(InOutGrid, OutStats);
+		for (const int32 CellIndex : InOutGrid.NodeCells)
+		{
+			OutChangedCoords.Add(InOutGrid.GetCoord(CellIndex));
+		}
+		return false;
+	}
+
+	// Each stage runs on the rings whose inputs changed and on the rings an earlier stage touched.
+	FXkHexagonGenerateBand Bands[(int32)EXkHexagonGenerateStage::PostProcess];
+	Bands[(int32)EXkHexagonGenerateStage::Layout].Add(OldSettings.GetOuterManhattanDistance(), Settings.GetOuterManhattanDistance());
+	Bands[(int32)EXkHexagonGenerateStage::Classification].Add(OldSettings.GroundManhattanDistance, Settings.GroundManhattanDistance);
+	if (GetStageHash(OldSettings, EXkHexagonGenerateStage::Classification) != GetStageHash(Settings, EXkHexagonGenerateStage::Classification))
+	{
+		Bands[(int32)EXkHexagonGenerateStage::Classification].bAll = true;
+	}
+	if (GetStageHash(OldSettings, EXkHexagonGenerateStage::HeightSplat) != GetStageHash(Settings, EXkHexagonGenerateStage::HeightSplat))
+	{
+		Bands[(int32)EXkHexagonGenerateStage::HeightSplat].bAll = true;
+	}
+	for (int32 StageIndex = 1; StageIndex < (int32)EXkHexagonGenerateStage::PostProcess; StageIndex++)
+	{
+		Bands[StageIndex].Add(Bands[StageIndex - 1]);
+	}
+
+	// Nodes of the rings the world shrank out of are removed.
+	const int32 OuterDistance = Settings.GetOuterManhattanDistance();
+	for (const int32 CellIndex : InOutGrid.NodeCells)
+	{
+		const FIntVector Coord = InOutGrid.GetCoord(CellIndex);
+		if (FXkHexagonAStarPathfinding::CalcManhattanDistance(Coord, FIntVector(0, 0, 0)) >= OuterDistance)
+		{
+			OutChangedCoords.Add(Coord);
+		}
+	}
+	InOutGrid.Resize(Settings.GetMaxManhattanDistance());
+
+	for (int32 StageIndex = 0; StageIndex < (int32)EXkHexagonGenerateStage::Num; StageIndex++)
+	{
+		const EXkHexagonGenerateStage Stage = (EXkHexagonGenerateStage)StageIndex;
+		if (OutStats)
+		{
+			OutStats->StageSeconds[StageIndex] = 0.0;
+		}
+		if (Stage != EXkHexagonGenerateStage::PostProcess && Bands[StageIndex].IsEmpty())
+		{
+			continue;
+		}
+		const double StartSeconds = FPlatformTime::Seconds();
+		if (Stage == EXkHexagonGenerateStage::PostProcess)
+		{
+			RunPostProcess(InOutGrid);
+		}
+		else
+		{
+			RunStage(Stage, InOutGrid, Bands[StageIndex]);
+		}
+		if (OutStats)
+		{
+			OutStats->StageSeconds[StageIndex] = FPlatformTime::Seconds() - StartSeconds;
+		}
+	}
+	InOutGrid.GeneratedSettings = Settings;
+	InOutGrid.CompletedStageNum = (int32)EXkHexagonGenerateStage::Num;
+	if (OutStats)
+	{
+		OutStats->NodeNum = InOutGrid.NodeCells.Num();
+	}
+
+	// The last band holds every cell any stage ran on.
+	const FXkHexagonGenerateBand& ChangedBand = Bands[(int32)EXkHexagonGenerateStage::HeightSplat];
+	for (const int32 CellIndex : InOutGrid.NodeCells)
+	{
+		const FIntVector Coord = InOutGrid.GetCoord(CellIndex);
+		if (ChangedBand.Contains(FXkHexagonAStarPathfinding::CalcManhattanDistance(Coord, FIntVector(0, 0, 0))))
+		{
+			OutChangedCoords.Add(Coord);
+		}
+	}
+	return true;
+}
+
+
+uint32 FXkHexagonalWorldGenerator::GetStageHash(const FXkHexagonalWorldGenerateSettings& InSettings, const EXkHexagonGenerateStage InStage)
+{
+	uint32 Hash = GetTypeHash((int32)InStage);
+	switch (InStage)
+	{
+	case EXkHexagonGenerateStage::Layout:
+		Hash = HashCombine(Hash, GetTypeHash(InSettings.Radius));
+		Hash = HashCombine(Hash, GetTypeHash(InSettings.GapWidth));
+		break;
+	case EXkHexagonGenerateStage::HeightSplat:
+		Hash = HashCombine(Hash, GetTypeHash(InSettings.WorldSeed));
+		Hash = HashCombine(Hash, GetTypeHash(InSettings.HeightNoiseSize));
+		for (const FXkHexagonSplat& HexagonSplat : InSettings.HexagonSplats)
+		{
+			Hash = HashCombine(Hash, GetTypeHash((uint8)HexagonSplat.TargetType));
+			Hash = HashCombine(Hash, GetTypeHash(HexagonSplat.Height));
+			Hash = HashCombine(Hash, GetTypeHash(HexagonSplat.NoiseHeight));
+			Hash = HashCombine(Hash, GetTypeHash(HexagonSplat.Splats.Num()));
+			for (const uint8 Splat : HexagonSplat.Splats)
+			{
+				Hash = HashCombine(Hash, GetTypeHash(Splat));
+			}
+		}
+		break;
+	default:
+		// Classification only reads the ground distance, tracked as a band.
+		break;
+	}
+	return Hash;
+}
+
+
+const TCHAR* FXkHexagonalWorldGenerator::GetStageName(const EXkHexagonGenerateStage InStage)
+{
+	switch (InStage)
+	{
+	case EXkHexagonGenerateStage::Layout: return TEXT("Layout");
+	case EXkHexagonGenerateStage::Classification: return TEXT("Classification");
+	case EXkHexagonGenerateStage::HeightSplat: return TEXT("HeightSplat");
+	case EXkHexagonGenerateStage::PostProcess: return TEXT("PostProcess");
+	default: return TEXT("Unknown");
+	}
+}
+
+
+bool FXkHexagonalWorldGenerator::LayoutCell(const FXkHexagonalWorldGenerateSettings& InSettings, const FIntVector& InCoord, uint8& OutType, FVector4f& OutPosition)
+{
+	const int32 ManhattanDistanceToCenter = FXkHexagonAStarPathfinding::CalcManhattanDistance(InCoord, FIntVector(0, 0, 0));
+	if (ManhattanDistanceToCenter >= (InSettings.GroundManhattanDistance + InSettings.ShorelineManhattanDistance))
+	{
+		return false;
+	}
+	const float Dist = InSettings.Radius + InSettings.GapWidth;
+	OutType = (uint8)(EXkHexagonType::Ocean | EXkHexagonType::Unavailable);
+	OutPosition = FVector4f(1.5f * Dist * InCoord.X, XkCos30 * Dist * (InCoord.Z - InCoord.Y), 0.0f, InSettings.Radius);
+	return true;
+}
+
+
+uint8 FXkHexagonalWorldGenerator::ClassifyCell(const FXkHexagonalWorldGenerateSettings& InSettings, const FIntVector& InCoord)
+{
+	const int32 ManhattanDistanceToCenter = FXkHexagonAStarPathfinding::CalcManhattanDistance(InCoord, FIntVector(0, 0, 0));
+	return (uint8)((ManhattanDistanceToCenter < InSettings.GroundManhattanDistance) ? EXkHexagonType::Land : EXkHexagonType::Sand);
+}
+
+
+float FXkHexagonalWorldGenerator::HeightNoiseCell(const FXkHexagonalWorldGenerateSettings& InSettings, const FVector4f& InPosition)
+{
+	if (InSettings.HeightNoiseSize <= 0.0f)
+	{
+		return 0.0f;
+	}
+	// The scalar path runs lane 0 of the batch path, grid and single node get the same height.
+	return FXkNoiseFBM::FBMSimulate(GetHeightNoiseST(InSettings.HeightNoiseSize, InPosition));
+}
+
+
+void FXkHexagonalWorldGenerator::HeightSplatCell(const FXkHexagonalWorldGenerateSettings& InSettings, const uint8 InType, const uint32 InRandom, const float InHeightNoise, FVector4f& InOutPosition, uint8& OutSplat)
+{
+	for (const FXkHexagonSplat& HexagonSplat : InSettings.HexagonSplats)
+	{
+		if ((EXkHexagonType)InType == HexagonSplat.TargetType && HexagonSplat.Splats.Num() > 0)
+		{
+			InOutPosition.Z = HexagonSplat.Height + HexagonSplat.NoiseHeight * InHeightNoise;
+			OutSplat = HexagonSplat.Splats[FXkHexagonRandom::MapRange(InRandom, 0, HexagonSplat.Splats.Num() - 1)];
+		}
+	}
+}
+
+
+void FXkHexagonalWorldGenerator::RunLayout(FXkHexagonalWorldGrid& InOutGrid, const FXkHexagonGenerateBand& InBand) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FXkHexagonalWorldGenerator::RunLayout);
+
+	if (InBand.bAll)
+	{
+		InOutGrid.Allocate(Settings.GetMaxManhattanDistance());
+	}
+	const int32 R = InOutGrid.MaxManhattanDistance;
+	ParallelFor(InOutGrid.Pitch, [this, &InOutGrid, &InBand, R](int32 Row)
+		{
+			const int32 X = Row - R;
+			for (int32 Y = -R; Y <= R; Y++)
+			{
+				const FIntVector Coord = FIntVector(X, Y, -X - Y);
+				if (!InBand.Contains(FXkHexagonAStarPathfinding::CalcManhattanDistance(Coord, FIntVector(0, 0, 0))))
+				{
+					continue;
+				}
+				const int32 CellIndex = InOutGrid.GetCellIndex(X, Y);
+				if (!LayoutCell(Settings, Coord, InOutGrid.Types[CellIndex], InOutGrid.Positions[CellIndex]))
+				{
+					InOutGrid.Types[CellIndex] = 0;
+					InOutGrid.Splats[CellIndex] = 0;
+					InOutGrid.Positions[CellIndex] = FVector4f::Zero();
+					InOutGrid.CustomData[CellIndex] = FVector4f::Zero();
+				}
+			}
+		});
+}
+
+
+void FXkHexagonalWorldGenerator::RunClassification(FXkHexagonalWorldGrid& InOutGrid, const FXkHexagonGenerateBand& InBand) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FXkHexagonalWorldGenerator::RunClassification);
+
+	const int32 R = InOutGrid.MaxManhattanDistance;
+	ParallelFor(InOutGrid.Pitch, [this, &InOutGrid, &InBand, R](int32 Row)
+		{
+			const int32 X = Row - R;
+			for (int32 Y = -R; Y <= R; Y++)
+			{
+				const int32 CellIndex = InOutGrid.GetCellIndex(X, Y);
+				const FIntVector Coord = FIntVector(X, Y, -X - Y);
+				if (InOutGrid.Types[CellIndex] != 0 && InBand.Contains(FXkHexagonAStarPathfinding::CalcManhattanDistance(Coord, FIntVector(0, 0, 0))))
+				{
+					InOutGrid.Types[CellIndex] = ClassifyCell(Settings, Coord);
+				}
+			}
+		});
+}
+
+
+void FXkHexagonalWorldGenerator::RunHeightSplat(FXkHexagonalWorldGrid& InOutGrid, const FXkHexagonGenerateBand& InBand) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FXkHexagonalWorldGenerator::RunHeightSplat);
+
+	const int32 R = InOutGrid.MaxManhattanDistance;
+	ParallelFor(InOutGrid.Pitch, [this, &InOutGrid, &InBand, R](int32 Row)
+		{
+			const int32 X = Row - R;
+			// Hash the whole row at once, four coords per SIMD iteration.
+			TArray<FIntVector, TInlineAllocator<256>> Coords;
+			TArray<uint32, TInlineAllocator<256>> Randoms;
+			Coords.SetNumUninitialized(InOutGrid.Pitch);
+			Randoms.SetNumUninitialized(InOutGrid.Pitch);
+			for (int32 Y = -R; Y <= R; Y++)
+			{
+				Coords[Y + R] = FIntVector(X, Y, -X - Y);
+			}
+			FXkHexagonRandom::RandomBatch(Settings.WorldSeed, HEXAGON_RANDOM_STREAM_SPLAT, Coords.GetData(), Randoms.GetData(), InOutGrid.Pitch);
+			// Terrain noise of the whole row, eight positions per SIMD iteration.
+			TArray<float, TInlineAllocator<256>> HeightNoises;
+			HeightNoises.SetNumZeroed(InOutGrid.Pitch);
+			if (Settings.HeightNoiseSize > 0.0f)
+			{
+				TArray<FVector2f, TInlineAllocator<256>> NoiseST;
+				NoiseST.SetNumUninitialized(InOutGrid.Pitch);
+				for (int32 Y = -R; Y <= R; Y++)
+				{
+					NoiseST[Y + R] = GetHeightNoiseST(Settings.HeightNoiseSize, InOutGrid.Positions[InOutGrid.GetCellIndex(X, Y)]);
+				}
+				FXkNoiseFBM::FBMSimulateBatch(NoiseST.GetData(), HeightNoises.GetData(), InOutGrid.Pitch);
+			}
+
+			for (int32 Y = -R; Y <= R; Y++)
+			{
+				const int32 CellIndex = InOutGrid.GetCellIndex(X, Y);
+				if (InOutGrid.Types[CellIndex] != 0 && InBand.Contains(FXkHexagonAStarPathfinding::CalcManhattanDistance(Coords[Y + R], FIntVector(0, 0, 0))))
+				{
+					// Run again on a generated cell, drop the height and splat of its previous type.
+					InOutGrid.Positions[CellIndex].Z = 0.0f;
+					InOutGrid.Splats[CellIndex] = 0;
+					HeightSplatCell(Settings, InOutGrid.Types[CellIndex], Randoms[Y + R], HeightNoises[Y + R], InOutGrid.Positions[CellIndex], InOutGrid.Splats[CellIndex]);
+				}
+			}
+		});
+}
+
+
+void FXkHexagonalWorldGenerator::RunPostProcess(FXkHexagonalWorldGrid& InOutGrid) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FXkHexagonalWorldGenerator::RunPostProcess);
+
+	// Count per row in parallel, then a prefix sum keeps the compacted order independent of scheduling.
+	TArray<int32> RowOffsets;
+	RowOffsets.SetNumZeroed(InOutGrid.Pitch + 1);
+	ParallelFor(InOutGrid.Pitch, [&InOutGrid, &RowOffsets](int32 Row)
+		{
+			int32 Count = 0;
+			const uint8* Types = InOutGrid.Types.GetData() + Row * InOutGrid.Pitch;
+			for (int32 Column = 0; Column < InOutGrid.Pitch; Column++)
+			{
+				Count += (Types[Column] != 0) ? 1 : 0;
+			}
+			RowOffsets[Row + 1] = Count;
+		});
+	for (int32 Row = 0; Row < InOutGrid.Pitch; Row++)
+	{
+		RowOffsets[Row + 1] += RowOffsets[Row];
+	}
+
+	InOutGrid.NodeCells.SetNumUninitialized(RowOffsets[InOutGrid.Pitch]);
+	ParallelFor(InOutGrid.Pitch, [&InOutGrid, &RowOffsets](int32 Row)
+		{
+			int32 NodeIndex = RowOffsets[Row];
+			const int32 RowStart = Row * InOutGrid.Pitch;
+			for (int32 Column = 0; Column < InOutGrid.Pitch; Column++)
+			{
+				if (InOutGrid.Types[RowStart + Column] != 0)
+				{
+					InOutGrid.NodeCells[NodeIndex++] = RowStart + Column;
+				}
+			}
+		});
+}
@@ -0,0 +1,193 @@
+// Copyright ©ICEPRINCE. All Rights Reserved.
+
+
+#include "XkHexagon/XkHexagonGeometry.h"
+#include "XkHexagon/XkHexagonPathfinding.h"
+#include "RenderingThread.h"
+#include "Misc/ScopeLock.h"
+
+
+void FXkHexagonGeometryVertexBuffer::InitRHI()
+{
+	FRHIResourceCreateInfo CreateInfo(TEXT("XkHexagonGeometryVertexBuffer"));
+	VertexBufferRHI = RHICreateVertexBuffer(
+		Vertices.Num() * sizeof(FVector4f),
+		BUF_Static | BUF_ShaderResource, CreateInfo);
+	void* RawVertexBuffer = RHILockBuffer(VertexBufferRHI, 0, Vertices.Num() * sizeof(FVector4f), RLM_WriteOnly);
+	FMemory::Memcpy(RawVertexBuffer, Vertices.GetData(), Vertices.Num() * sizeof(FVector4f));
+	RHIUnlockBuffer(VertexBufferRHI);
+}
+
+
+void FXkHexagonGeometryIndexBuffer::InitRHI()
+{
+	FRHIResourceCreateInfo CreateInfo(TEXT("XkHexagonGeometryIndexBuffer"));
+	IndexBufferRHI = RHICreateIndexBuffer(sizeof(uint32), Indices.Num() * sizeof(uint32), BUF_Static, CreateInfo);
+	void* RawIndexBuffer = RHILockBuffer(IndexBufferRHI, 0, Indices.Num() * sizeof(uint32), RLM_WriteOnly);
+	FMemory::Memcpy(RawIndexBuffer, Indices.GetData(), Indices.Num() * sizeof(uint32));
+	RHIUnlockBuffer(IndexBufferRHI);
+}
+
+
+FXkHexagonGeometry::FXkHexagonGeometry(const FXkHexagonGeometryKey& InKey)
+	: Key(InKey)
+{
+	Build(Key, BaseVertices, BaseIndices, EdgeVertices, EdgeIndices);
+
+	Resources = new FResources();
+	Resources->VertexBuffer.Vertices.Reserve(HEXAGON_BASE_VERTEX_NUM + HEXAGON_EDGE_VERTEX_NUM);
+	Resources->VertexBuffer.Vertices.Append(BaseVertices);
+	Resources->VertexBuffer.Vertices.Append(EdgeVertices);
+	Resources->BaseIndexBuffer.Indices = BaseIndices;
+	Resources->EdgeIndexBuffer.Indices = EdgeIndices;
+	BeginInitResource(&Resources->VertexBuffer);
+	BeginInitResource(&Resources->BaseIndexBuffer);
+	BeginInitResource(&Resources->EdgeIndexBuffer);
+}
+
+
+FXkHexagonGeometry::~FXkHexagonGeometry()
+{
+	// The last holder may be a scene proxy on render thread, the command then runs inline.
+	FResources* ResourcesToRelease = Resources;
+	Resources = nullptr;
+	ENQUEUE_RENDER_COMMAND(ReleaseHexagonGeometry)(
+		[ResourcesToRelease](FRHICommandListImmediate& RHICmdList)
+		{
+			ResourcesToRelease->VertexBuffer.ReleaseResource();
+			ResourcesToRelease->BaseIndexBuffer.ReleaseResource();
+			ResourcesToRelease->EdgeIndexBuffer.ReleaseResource();
+			delete ResourcesToRelease;
+		});
+}
+
+
+void FXkHexagonGeometry::Build(const FXkHexagonGeometryKey& InKey, TArray<FVector4f>& OutBaseVertices, TArray<uint32>& OutBaseIndices, TArray<FVector4f>& OutEdgeVertices, TArray<uint32>& OutEdgeIndices)
+{
+	const float Radius = InKey.Radius;
+	const float Height = InKey.Height;
+	const float BaseInnerGap = InKey.BaseInnerGap;
+	const float BaseOuterGap = InKey.BaseOuterGap;
+	const float EdgeInnerGap = InKey.EdgeInnerGap;
+	const float EdgeOuterGap = InKey.EdgeOuterGap;
+
+	OutBaseVertices.Reset(HEXAGON_BASE_VERTEX_NUM);
+	OutBaseIndices.Reset(HEXAGON_BASE_INDEX_NUM);
+	OutEdgeVertices.Reset(HEXAGON_EDGE_VERTEX_NUM);
+	OutEdgeIndices.Reset(HEXAGON_EDGE_INDEX_NUM);
+
+	FVector4f TopBoundaryVertices[6];
+	FVector4f BtmBoundaryVertices[6];
+
+	// Two triangles of the quad starting at InIndex
+	auto AddQuadIndices = [](TArray<uint32>& OutIndices, const uint32 InIndex)
+	{
+		OutIndices.Add(InIndex);
+		OutIndices.Add(InIndex + 2);
+		OutIndices.Add(InIndex + 1);
+		OutIndices.Add(InIndex + 1);
+		OutIndices.Add(InIndex + 2);
+		OutIndices.Add(InIndex + 3);
+	};
+
+	{
+		//	x
+		//	|   1
+		//	| 2/ \6
+		//	| | 0 |
+		//	| 3\ /5
+		//	|   4
+		//	---------y
+
+		const float TopRadius = Radius - BaseInnerGap;
+		TopBoundaryVertices[0] = FVector4f(TopRadius, 0.0, Height, 1.0);
+		TopBoundaryVertices[1] = FVector4f(TopRadius * XkSin30, -XkCos30 * TopRadius, Height, 1.0);
+		TopBoundaryVertices[2] = FVector4f(-TopRadius * XkSin30, -XkCos30 * TopRadius, Height, 1.0);
+		TopBoundaryVertices[3] = FVector4f(-TopRadius, 0.0, Height, 1.0);
+		TopBoundaryVertices[4] = FVector4f(-TopRadius * XkSin30, XkCos30 * TopRadius, Height, 1.0);
+		TopBoundaryVertices[5] = FVector4f(TopRadius * XkSin30, XkCos30 * TopRadius, Height, 1.0);
+		const float BtmRadius = Radius - BaseOuterGap;
+		BtmBoundaryVertices[0] = FVector4f(BtmRadius, 0.0, 0.0, 1.0);
+		BtmBoundaryVertices[1] = FVector4f(BtmRadius * XkSin30, -XkCos30 * Radius, 0.0, 1.0);
+		BtmBoundaryVertices[2] = FVector4f(-BtmRadius * XkSin30, -XkCos30 * Radius, 0.0, 1.0);
+		BtmBoundaryVertices[3] = FVector4f(-BtmRadius, 0.0, 0.0, 1.0);
+		BtmBoundaryVertices[4] = FVector4f(-BtmRadius * XkSin30, XkCos30 * Radius, 0.0, 1.0);
+		BtmBoundaryVertices[5] = FVector4f(BtmRadius * XkSin30, XkCos30 * Radius, 0.0, 1.0);
+
+		OutBaseVertices.Add(FVector4f(0.0, 0.0, Height, 1.0));
+		OutBaseVertices.Append(TopBoundaryVertices, 6);
+		OutBaseIndices.Append({ 0, 1, 2, 0, 2, 3, 0, 3, 4, 0, 4, 5, 0 , 5, 6, 0, 6, 1 });
+		for (int32 i = 0; i < 6; i++)
+		{
+			const int32 IndexA = (i + 1) % 6;
+			const int32 IndexB = (i + 1 + 1) % 6;
+			const uint32 CurrIndex = OutBaseVertices.Num();
+			OutBaseVertices.Add(TopBoundaryVertices[IndexA]);
+			OutBaseVertices.Add(TopBoundaryVertices[IndexB]);
+			OutBaseVertices.Add(BtmBoundaryVertices[IndexA]);
+			OutBaseVertices.Add(BtmBoundaryVertices[IndexB]);
+			AddQuadIndices(OutBaseIndices, CurrIndex);
+		}
+	}
+
+	{
+		// XkHexagon Edge ->|-----------|------------|-------------|----------> XkHexagon Center
+		//		    BaseOuterGap EdgeOuterGap EdgeInnerGap BaseInnerGap
+		const float EdgeHeight = Height + 1; // Fix Z-fighting
+		const float TopRadius = Radius - EdgeInnerGap;
+		TopBoundaryVertices[0] = FVector4f(TopRadius, 0.0, EdgeHeight, 1.0);
+		TopBoundaryVertices[1] = FVector4f(TopRadius * XkSin30, -XkCos30 * TopRadius, EdgeHeight, 1.0);
+		TopBoundaryVertices[2] = FVector4f(-TopRadius * XkSin30, -XkCos30 * TopRadius, EdgeHeight, 1.0);
+		TopBoundaryVertices[3] = FVector4f(-TopRadius, 0.0, EdgeHeight, 1.0);
+		TopBoundaryVertices[4] = FVector4f(-TopRadius * XkSin30, XkCos30 * TopRadius, EdgeHeight, 1.0);
+		TopBoundaryVertices[5] = FVector4f(TopRadius * XkSin30, XkCos30 * TopRadius, EdgeHeight, 1.0);
+		const float BtmRadius = Radius - EdgeOuterGap;
+		BtmBoundaryVertices[0] = FVector4f(BtmRadius, 0.0, EdgeHeight, 1.0);
+		BtmBoundaryVertices[1] = FVector4f(BtmRadius * XkSin30, -XkCos30 * BtmRadius, EdgeHeight, 1.0);
+		BtmBoundaryVertices[2] = FVector4f(-BtmRadius * XkSin30, -XkCos30 * BtmRadius, EdgeHeight, 1.0);
+		BtmBoundaryVertices[3] = FVector4f(-BtmRadius, 0.0, EdgeHeight, 1.0);
+		BtmBoundaryVertices[4] = FVector4f(-BtmRadius * XkSin30, XkCos30 * BtmRadius, EdgeHeight, 1.0);
+		BtmBoundaryVertices[5] = FVector4f(BtmRadius * XkSin30, XkCos30 * BtmRadius, EdgeHeight, 1.0);
+
+		for (int32 i = 0; i < 6; i++)
+		{
+			const int32 IndexA = (i + 1) % 6;
+			const int32 IndexB = (i + 1 + 1) % 6;
+			const uint32 CurrIndex = OutEdgeVertices.Num();
+			OutEdgeVertices.Add(TopBoundaryVertices[IndexA]);
+			OutEdgeVertices.Add(TopBoundaryVertices[IndexB]);
+			OutEdgeVertices.Add(BtmBoundaryVertices[IndexA]);
+			OutEdgeVertices.Add(BtmBoundaryVertices[IndexB]);
+			AddQuadIndices(OutEdgeIndices, CurrIndex);
+		}
+	}
+
+	check(OutBaseVertices.Num() == HEXAGON_BASE_VERTEX_NUM && OutBaseIndices.Num() == HEXAGON_BASE_INDEX_NUM);
+	check(OutEdgeVertices.Num() == HEXAGON_EDGE_VERTEX_NUM && OutEdgeIndices.Num() == HEXAGON_EDGE_INDEX_NUM);
+}
+
+
+FXkHexagonGeometryPtr FXkHexagonGeometryCache::Get(const FXkHexagonGeometryKey& InKey)
+{
+	typedef TWeakPtr<const FXkHexagonGeometry, ESPMode::ThreadSafe> FXkHexagonGeometryWeakPtr;
+	static FCriticalSection Mutex;
+	static TMap<FXkHexagonGeometryKey, FXkHexagonGeometryWeakPtr> Geometries;
+
+	FScopeLock Lock(&Mutex);
+	if (FXkHexagonGeometryPtr Geometry = Geometries.FindRef(InKey).Pin())
+	{
+		return Geometry;
+	}
+
+	// Keys of released geometries only pile up while the sizes are being edited.
+	for (auto It = Geometries.CreateIterator(); It; ++It)
+	{
+		if (!It.Value().IsValid())
+		{
+			It.RemoveCurrent();
+		}
+	}
+	FXkHexagonGeometryPtr Geometry = MakeShared<const FXkHexagonGeometry, ESPMode::ThreadSafe>(InKey);
+	Geometries.Add(InKey, Geometry);
+	return Geometry;
+}
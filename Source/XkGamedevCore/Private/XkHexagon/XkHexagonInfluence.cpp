@@ -0,0 +1,229 @@
+// Copyright ©ICEPRINCE. All Rights Reserved.
+
+
+#include "XkHexagon/XkHexagonInfluence.h"
+
+
+float FXkHexagonInfluenceSnapshot::GetInfluence(const EXkHexagonInfluenceLayer InLayer, const FIntVector& InCoord) const
+{
+	if (FMath::Abs(InCoord.X) > MaxManhattanDistance || FMath::Abs(InCoord.Y) > MaxManhattanDistance || Pitch == 0)
+	{
+		return 0.0f;
+	}
+	const int32 Index = (InCoord.X + MaxManhattanDistance) * Pitch + (InCoord.Y + MaxManhattanDistance);
+	return Layers[(int32)InLayer][Index];
+}
+
+
+FXkHexagonInfluenceMap::FXkHexagonInfluenceMap() :
+	MaxManhattanDistance(0),
+	Pitch(0),
+	Version(0)
+{
+}
+
+
+FXkHexagonInfluenceMap::~FXkHexagonInfluenceMap()
+{
+	Stamps.Empty();
+	Kernels.Empty();
+	CachedSnapshot.Reset();
+}
+
+
+void FXkHexagonInfluenceMap::Initialize(const int32 InMaxManhattanDistance)
+{
+	MaxManhattanDistance = FMath::Max(InMaxManhattanDistance, 0);
+	Pitch = MaxManhattanDistance * 2 + 1;
+	for (int32 LayerIndex = 0; LayerIndex < (int32)EXkHexagonInfluenceLayer::Num; LayerIndex++)
+	{
+		Layers[LayerIndex].Reset();
+		Layers[LayerIndex].SetNumZeroed(Pitch * Pitch);
+	}
+	Stamps.Empty();
+	CachedSnapshot.Reset();
+	Version++;
+}
+
+
+void FXkHexagonInfluenceMap::Resize(const int32 InMaxManhattanDistance)
+{
+	const int32 NewMaxManhattanDistance = FMath::Max(InMaxManhattanDistance, 0);
+	if (NewMaxManhattanDistance == MaxManhattanDistance && Pitch != 0)
+	{
+		return;
+	}
+	MaxManhattanDistance = NewMaxManhattanDistance;
+	Pitch = MaxManhattanDistance * 2 + 1;
+	for (int32 LayerIndex = 0; LayerIndex < (int32)EXkHexagonInfluenceLayer::Num; LayerIndex++)
+	{
+		Layers[LayerIndex].SetNumUninitialized(Pitch * Pitch);
+	}
+	// Rebuild zeroes the layers and stamps the kept stamps into the new extent.
+	Rebuild();
+}
+
+
+int32 FXkHexagonInfluenceMap::AddStamp(const FXkHexagonInfluenceStamp& InStamp)
+{
+	const int32 Handle = Stamps.Add(InStamp);
+	ApplyStamp(InStamp, 1.0f);
+	return Handle;
+}
+
+
+void FXkHexagonInfluenceMap::UpdateStamp(const int32 InHandle, const FXkHexagonInfluenceStamp& InStamp)
+{
+	if (!Stamps.IsValidIndex(InHandle))
+	{
+		return;
+	}
+	ApplyStamp(Stamps[InHandle], -1.0f);
+	Stamps[InHandle] = InStamp;
+	ApplyStamp(InStamp, 1.0f);
+}
+
+
+void FXkHexagonInfluenceMap::MoveStamp(const int32 InHandle, const FIntVector& InCoord)
+{
+	if (!Stamps.IsValidIndex(InHandle) || Stamps[InHandle].Coord == InCoord)
+	{
+		return;
+	}
+	FXkHexagonInfluenceStamp Stamp = Stamps[InHandle];
+	Stamp.Coord = InCoord;
+	UpdateStamp(InHandle, Stamp);
+}
+
+
+void FXkHexagonInfluenceMap::RemoveStamp(const int32 InHandle)
+{
+	if (!Stamps.IsValidIndex(InHandle))
+	{
+		return;
+	}
+	ApplyStamp(Stamps[InHandle], -1.0f);
+	Stamps.RemoveAt(InHandle);
+}
+
+
+void FXkHexagonInfluenceMap::Rebuild()
+{
+	for (int32 LayerIndex = 0; LayerIndex < (int32)EXkHexagonInfluenceLayer::Num; LayerIndex++)
+	{
+		FMemory::Memzero(Layers[LayerIndex].GetData(), Layers[LayerIndex].Num() * sizeof(float));
+	}
+	for (const FXkHexagonInfluenceStamp& Stamp : Stamps)
+	{
+		ApplyStamp(Stamp, 1.0f);
+	}
+	Version++;
+}
+
+
+float FXkHexagonInfluenceMap::GetInfluence(const EXkHexagonInfluenceLayer InLayer, const FIntVector& InCoord) const
+{
+	if (FMath::Abs(InCoord.X) > MaxManhattanDistance || FMath::Abs(InCoord.Y) > MaxManhattanDistance || Pitch == 0)
+	{
+		return 0.0f;
+	}
+	return Layers[(int32)InLayer][GetCellIndex(InCoord.X, InCoord.Y)];
+}
+
+
+TSharedRef<const FXkHexagonInfluenceSnapshot, ESPMode::ThreadSafe> FXkHexagonInfluenceMap::PublishSnapshot()
+{
+	if (!CachedSnapshot.IsValid() || CachedSnapshot->Version != Version)
+	{
+		TSharedRef<FXkHexagonInfluenceSnapshot, ESPMode::ThreadSafe> Snapshot = MakeShared<FXkHexagonInfluenceSnapshot, ESPMode::ThreadSafe>();
+		Snapshot->MaxManhattanDistance = MaxManhattanDistance;
+		Snapshot->Pitch = Pitch;
+		Snapshot->Version = Version;
+		for (int32 LayerIndex = 0; LayerIndex < (int32)EXkHexagonInfluenceLayer::Num; LayerIndex++)
+		{
+			Snapshot->Layers[LayerIndex] = Layers[LayerIndex];
+		}
+		CachedSnapshot = Snapshot;
+	}
+	return CachedSnapshot.ToSharedRef();
+}
+
+
+void FXkHexagonInfluenceMap::ApplyStamp(const FXkHexagonInfluenceStamp& InStamp, const float InSign)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FXkHexagonInfluenceMap::ApplyStamp);
+
+	if (Pitch == 0 || InStamp.Radius < 0 || InStamp.Strength == 0.0f)
+	{
+		return;
+	}
+
+	const FInfluenceKernel& Kernel = FindOrBuildKernel(InStamp.Radius);
+	float* LayerData = Layers[(int32)InStamp.Layer].GetData();
+	const float Scale = InStamp.Strength * InSign;
+	const VectorRegister4Float ScaleVec = VectorSetFloat1(Scale);
+
+	for (int32 Row = 0; Row < Kernel.RowMinY.Num(); Row++)
+	{
+		const int32 X = InStamp.Coord.X + Row - InStamp.Radius;
+		if (X < -MaxManhattanDistance || X > MaxManhattanDistance)
+		{
+			continue;
+		}
+		// Each kernel row is contiguous in the layer because Y is the inner dimension.
+		const int32 MinY = InStamp.Coord.Y + Kernel.RowMinY[Row];
+		const int32 MaxY = MinY + (Kernel.RowOffsets[Row + 1] - Kernel.RowOffsets[Row]) - 1;
+		const int32 ClipMinY = FMath::Max(MinY, -MaxManhattanDistance);
+		const int32 ClipMaxY = FMath::Min(MaxY, MaxManhattanDistance);
+		if (ClipMinY > ClipMaxY)
+		{
+			continue;
+		}
+
+		const float* Weights = Kernel.Weights.GetData() + Kernel.RowOffsets[Row] + (ClipMinY - MinY);
+		float* Cells = LayerData + GetCellIndex(X, ClipMinY);
+		const int32 Count = ClipMaxY - ClipMinY + 1;
+		int32 Index = 0;
+		for (; Index + 4 <= Count; Index += 4)
+		{
+			VectorRegister4Float Accum = VectorLoad(Cells + Index);
+			Accum = VectorMultiplyAdd(VectorLoad(Weights + Index), ScaleVec, Accum);
+			VectorStore(Accum, Cells + Index);
+		}
+		for (; Index < Count; Index++)
+		{
+			Cells[Index] += Weights[Index] * Scale;
+		}
+	}
+	Version++;
+}
+
+
+const FXkHexagonInfluenceMap::FInfluenceKernel& FXkHexagonInfluenceMap::FindOrBuildKernel(const int32 InRadius)
+{
+	if (const FInfluenceKernel* Found = Kernels.Find(InRadius))
+	{
+		return *Found;
+	}
+
+	FInfluenceKernel& Kernel = Kernels.Add(InRadius);
+	const int32 RowNum = InRadius * 2 + 1;
+	Kernel.RowMinY.Reserve(RowNum);
+	Kernel.RowOffsets.Reserve(RowNum + 1);
+	Kernel.Weights.Reserve(RowNum * RowNum);
+	for (int32 DX = -InRadius; DX <= InRadius; DX++)
+	{
+		// Cells with max(|DX|, |DY|, |DX + DY|) <= Radius
+		const int32 MinDY = FMath::Max(-InRadius, -InRadius - DX);
+		const int32 MaxDY = FMath::Min(InRadius, InRadius - DX);
+		Kernel.RowMinY.Add(MinDY);
+		Kernel.RowOffsets.Add(Kernel.Weights.Num());
+		for (int32 DY = MinDY; DY <= MaxDY; DY++)
+		{
+			const int32 Distance = FMath::Max3(FMath::Abs(DX), FMath::Abs(DY), FMath::Abs(DX + DY));
+			Kernel.Weights.Add(1.0f - (float)Distance / (float)(InRadius + 1));
+		}
+	}
+	Kernel.RowOffsets.Add(Kernel.Weights.Num());
+	return Kernel;
+}
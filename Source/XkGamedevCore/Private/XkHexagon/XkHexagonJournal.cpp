@@ -0,0 +1,128 @@
+// Copyright ©ICEPRINCE. All Rights Reserved.
+
+
+#include "XkHexagon/XkHexagonJournal.h"
+
+
+FXkHexagonalWorldChangeJournal::FXkHexagonalWorldChangeJournal() :
+	FirstSequence(0),
+	NextSequence(0)
+{
+}
+
+
+void FXkHexagonalWorldChangeJournal::Record(const FIntVector& InCoord, const EXkHexagonNodeField InFields)
+{
+	if (PendingFrame.bReset || Cursors.Num() == 0)
+	{
+		return;
+	}
+	if (const int32* Index = PendingIndices.Find(InCoord))
+	{
+		PendingFrame.Changes[*Index].Fields |= InFields;
+		return;
+	}
+	PendingIndices.Add(InCoord, PendingFrame.Changes.Add(FXkHexagonNodeChange(InCoord, InFields)));
+}
+
+
+void FXkHexagonalWorldChangeJournal::RecordReset()
+{
+	PendingFrame.bReset = true;
+	PendingFrame.Changes.Empty();
+	PendingIndices.Empty();
+}
+
+
+void FXkHexagonalWorldChangeJournal::EndFrame()
+{
+	if (!PendingFrame.bReset && PendingFrame.Changes.Num() == 0)
+	{
+		return;
+	}
+	Frames.Add(MoveTemp(PendingFrame));
+	PendingFrame = FJournalFrame();
+	PendingIndices.Reset();
+	NextSequence++;
+	TrimFrames();
+}
+
+
+int32 FXkHexagonalWorldChangeJournal::Subscribe()
+{
+	return Cursors.Add(NextSequence);
+}
+
+
+void FXkHexagonalWorldChangeJournal::Unsubscribe(const int32 InHandle)
+{
+	if (Cursors.IsValidIndex(InHandle))
+	{
+		Cursors.RemoveAt(InHandle);
+		TrimFrames();
+	}
+}
+
+
+bool FXkHexagonalWorldChangeJournal::Consume(const int32 InHandle, TArray<FXkHexagonNodeChange>& OutChanges)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FXkHexagonalWorldChangeJournal::Consume);
+
+	OutChanges.Reset();
+	if (!Cursors.IsValidIndex(InHandle))
+	{
+		return false;
+	}
+
+	uint64& Cursor = Cursors[InHandle];
+	bool bIncremental = Cursor >= FirstSequence;
+	if (bIncremental)
+	{
+		TMap<FIntVector, int32> ChangeIndices;
+		for (uint64 Sequence = Cursor; Sequence < NextSequence; Sequence++)
+		{
+			const FJournalFrame& Frame = Frames[(int32)(Sequence - FirstSequence)];
+			if (Frame.bReset)
+			{
+				bIncremental = false;
+				break;
+			}
+			for (const FXkHexagonNodeChange& Change : Frame.Changes)
+			{
+				if (const int32* Index = ChangeIndices.Find(Change.Coord))
+				{
+					OutChanges[*Index].Fields |= Change.Fields;
+					continue;
+				}
+				ChangeIndices.Add(Change.Coord, OutChanges.Add(Change));
+			}
+		}
+	}
+	if (!bIncremental)
+	{
+		OutChanges.Reset();
+	}
+
+	Cursor = NextSequence;
+	TrimFrames();
+	return bIncremental;
+}
+
+
+void FXkHexagonalWorldChangeJournal::TrimFrames()
+{
+	uint64 MinCursor = NextSequence;
+	for (const uint64 Cursor : Cursors)
+	{
+		MinCursor = FMath::Min(MinCursor, Cursor);
+	}
+	// Slow subscribers beyond MaxFrames fall back to a full rebuild on their next Consume.
+	MinCursor = FMath::Max(MinCursor, NextSequence > (uint64)MaxFrames ? NextSequence - MaxFrames : 0);
+
+	const int32 DropNum = (int32)(FMath::Max(MinCursor, FirstSequence) - FirstSequence);
+	if (DropNum > 0)
+	{
+		Frames.RemoveAt(0, DropNum, EAllowShrinking::No);
+		FirstSequence += DropNum;
+	}
+}
@@ -0,0 +1,55 @@
+// Copyright ©ICEPRINCE. All Rights Reserved.
+
+
+#include "XkHexagon/XkHexagonRandom.h"
+
+
+static FORCEINLINE VectorRegister4Int VectorHexagonHash(VectorRegister4Int Value)
+{
+	const VectorRegister4Int Multiplier0 = VectorIntSet1(0x7feb352d);
+	const VectorRegister4Int Multiplier1 = VectorIntSet1((int32)0x846ca68bU);
+	Value = VectorIntXor(Value, VectorShiftRightImmLogical(Value, 16));
+	Value = VectorIntMultiply(Value, Multiplier0);
+	Value = VectorIntXor(Value, VectorShiftRightImmLogical(Value, 15));
+	Value = VectorIntMultiply(Value, Multiplier1);
+	Value = VectorIntXor(Value, VectorShiftRightImmLogical(Value, 16));
+	return Value;
+}
+
+
+void FXkHexagonRandom::RandomBatch(const uint32 InSeed, const uint32 InStream, const FIntVector* InCoords, uint32* OutValues, const int32 InNum)
+{
+	const uint32 Key = Hash(InSeed ^ Hash(InStream));
+	const VectorRegister4Int KeyVec = VectorIntSet1((int32)Key);
+
+	int32 Index = 0;
+	for (; Index + 4 <= InNum; Index += 4)
+	{
+		const FIntVector* Coords = InCoords + Index;
+		const VectorRegister4Int X = MakeVectorRegisterInt(Coords[0].X, Coords[1].X, Coords[2].X, Coords[3].X);
+		const VectorRegister4Int Y = MakeVectorRegisterInt(Coords[0].Y, Coords[1].Y, Coords[2].Y, Coords[3].Y);
+		const VectorRegister4Int Z = MakeVectorRegisterInt(Coords[0].Z, Coords[1].Z, Coords[2].Z, Coords[3].Z);
+		VectorRegister4Int Value = VectorHexagonHash(VectorIntXor(KeyVec, X));
+		Value = VectorHexagonHash(VectorIntXor(Value, Y));
+		Value = VectorHexagonHash(VectorIntXor(Value, Z));
+		VectorIntStore(Value, OutValues + Index);
+	}
+	for (; Index < InNum; Index++)
+	{
+		uint32 Value = Hash(Key ^ (uint32)InCoords[Index].X);
+		Value = Hash(Value ^ (uint32)InCoords[Index].Y);
+		OutValues[Index] = Hash(Value ^ (uint32)InCoords[Index].Z);
+	}
+}
+
+
+void FXkHexagonRandom::RandRangeBatch(const uint32 InSeed, const uint32 InStream, const FIntVector* InCoords, const int32 InMin, const int32 InMax, int32* OutValues, const int32 InNum)
+{
+	// Hash in place, the int32 output has the size of the uint32 hash.
+	uint32* Values = reinterpret_cast<uint32*>(OutValues);
+	RandomBatch(InSeed, InStream, InCoords, Values, InNum);
+	for (int32 Index = 0; Index < InNum; Index++)
+	{
+		OutValues[Index] = MapRange(Values[Index], InMin, InMax);
+	}
+}
@@ -14,13 +14,116 @@
 #include "UObject/UObjectIterator.h"
 #include "StaticMeshResources.h"
 #include "MeshMaterialShader.h"
+#include "Misc/CoreDelegates.h"
+
+
+DECLARE_STATS_GROUP(TEXT("XkHexagon"), STATGROUP_XkHexagon, STATCAT_Advanced);
+DECLARE_MEMORY_STAT(TEXT("Instance Buffers Used"), STAT_XkHexagonInstanceBuffersUsed, STATGROUP_XkHexagon);
+DECLARE_MEMORY_STAT(TEXT("Instance Buffers Allocated"), STAT_XkHexagonInstanceBuffersAllocated, STATGROUP_XkHexagon);
+
+// One packed instance per slot, see FXkHexagonInstance
+static constexpr int64 HexagonInstanceBytes = sizeof(FXkHexagonInstance);
+// Capacity of the first instance buffers, enough for a small island
+static constexpr int32 MinHexagonInstanceCapacity = 1024;
+
+static int32 HexagonStaticDraw = 1;
+static FAutoConsoleVariableRef CVarHexagonStaticDraw(
+	TEXT("r.xk.HexagonStaticDraw"),
+	HexagonStaticDraw,
+	TEXT("Draw the base mesh, and the edge mesh without r.xk.HexagonEdgeLOD, of hexagonal worlds through one cached mesh draw command over every slot.\n")
+	TEXT("It costs no CPU per frame, but chunks out of view are not culled and free slots run the vertex shader as degenerate hexagons.\n")
+	TEXT("0 culls chunks per view every frame instead. Applies to proxies created afterwards."),
+	ECVF_RenderThreadSafe);
+
+static int32 HexagonEdgeLOD = 1;
+static FAutoConsoleVariableRef CVarHexagonEdgeLOD(
+	TEXT("r.xk.HexagonEdgeLOD"),
+	HexagonEdgeLOD,
+	TEXT("Pick the edge mesh of every chunk by the projected size of its hexagons, edges are then drawn per view. Applies to proxies created afterwards."),
+	ECVF_RenderThreadSafe);
+
+static float HexagonEdgeLOD1ScreenSize = 0.02f;
+static FAutoConsoleVariableRef CVarHexagonEdgeLOD1ScreenSize(
+	TEXT("r.xk.HexagonEdgeLOD1ScreenSize"),
+	HexagonEdgeLOD1ScreenSize,
+	TEXT("Hexagons smaller than this fraction of the screen draw three edge sides and rely on their neighbours for the others.\n")
+	TEXT("Chunks with highlighted edges, missing nodes, or a neighbour chunk without drawn edges keep the full ring."),
+	ECVF_RenderThreadSafe);
+
+static float HexagonEdgeLOD2ScreenSize = 0.008f;
+static FAutoConsoleVariableRef CVarHexagonEdgeLOD2ScreenSize(
+	TEXT("r.xk.HexagonEdgeLOD2ScreenSize"),
+	HexagonEdgeLOD2ScreenSize,
+	TEXT("Hexagons smaller than this fraction of the screen draw no edges."),
+	ECVF_RenderThreadSafe);
+
+static int32 HexagonSortChunks = 0;
+static FAutoConsoleVariableRef CVarHexagonSortChunks(
+	TEXT("r.xk.HexagonSortChunks"),
+	HexagonSortChunks,
+	TEXT("Draw the visible chunks of hexagonal worlds front to back every view, this takes them off the cached static path. Applies to proxies created afterwards."),
+	ECVF_RenderThreadSafe);
+
+
+/* Chunk that passed culling, with the key it is ordered by.*/
+struct FXkVisibleHexagonChunk
+{
+	uint32 DepthKey;
+	int32 Block;
+	int32 EdgeLOD;
+};
+
+
+static uint32 GetSortableDepthKey(const float InDepth)
+{
+	// Flip the sign bit of positive floats and every bit of negative ones, the bits then order as unsigned.
+	uint32 Bits = 0;
+	FMemory::Memcpy(&Bits, &InDepth, sizeof(float));
+	return Bits ^ ((Bits & 0x80000000) ? 0xFFFFFFFF : 0x80000000);
+}
+
+
+/* LSD radix sort by depth key, 8 bits per pass. A few hundred chunks sort in linear time every view.*/
+static void RadixSortVisibleChunks(TArray<FXkVisibleHexagonChunk, TInlineAllocator<64>>& InOutChunks)
+{
+	const int32 Num = InOutChunks.Num();
+	TArray<FXkVisibleHexagonChunk, TInlineAllocator<64>> Scratch;
+	Scratch.SetNumUninitialized(Num);
+	FXkVisibleHexagonChunk* Src = InOutChunks.GetData();
+	FXkVisibleHexagonChunk* Dst = Scratch.GetData();
+	for (uint32 Shift = 0; Shift < 32; Shift += 8)
+	{
+		uint32 Offsets[256] = {};
+		for (int32 i = 0; i < Num; i++)
+		{
+			Offsets[(Src[i].DepthKey >> Shift) & 0xFF]++;
+		}
+		uint32 Offset = 0;
+		for (uint32 Digit = 0; Digit < 256; Digit++)
+		{
+			const uint32 Count = Offsets[Digit];
+			Offsets[Digit] = Offset;
+			Offset += Count;
+		}
+		for (int32 i = 0; i < Num; i++)
+		{
+			Dst[Offsets[(Src[i].DepthKey >> Shift) & 0xFF]++] = Src[i];
+		}
+		Swap(Src, Dst);
+	}
+	// An even number of passes, the sorted chunks end up back in InOutChunks.
+}
 
 
 class FXkHexagonalWorldVertexFactoryShaderParameters : public FVertexFactoryShaderParameters
 {
 	DECLARE_TYPE_LAYOUT(FXkHexagonalWorldVertexFactoryShaderParameters, NonVirtual);
 public:
-	void Bind(const FShaderParameterMap& ParameterMap) {};
+	void Bind(const FShaderParameterMap& ParameterMap)
+	{
+		HexagonParameters.Bind(ParameterMap, TEXT("XkHexagonParameters"));
+		HexagonPalette.Bind(ParameterMap, TEXT("XkHexagonPalette"));
+	};
 
 	void GetElementShaderBindings(
 		const class FSceneInterface* Scene,
@@ -33,7 +136,24 @@ public:
 		class FMeshDrawSingleShaderBindings& ShaderBindings,
 		FVertexInputStreamArray& VertexStreams) const
 	{
+		// Positions are decoded from the instance coords and colors looked up from the palette, see XkVertexFactory.ush
+		const FXkHexagonalWorldVertexFactory* HexagonVertexFactory = static_cast<const FXkHexagonalWorldVertexFactory*>(VertexFactory);
+		ShaderBindings.Add(HexagonParameters, FVector4f(HexagonVertexFactory->HexagonDistance, (float)HexagonVertexFactory->PaletteChannel, 0.0f, 0.0f));
+		if (HexagonVertexFactory->PaletteBuffer)
+		{
+			ShaderBindings.Add(HexagonPalette, HexagonVertexFactory->PaletteBuffer->SRV);
+		}
+
+		// Each element draws a run of instances, UserIndex is the first slot of the run.
+		const uint32 InstanceOffset = BatchElement.UserIndex;
+		if (InstanceOffset > 0 && VertexStreams.Num() > 0)
+		{
+			VertexFactory->OffsetInstanceStreams(InstanceOffset, InputStreamType, VertexStreams);
+		}
 	}
+
+	LAYOUT_FIELD(FShaderParameter, HexagonParameters);
+	LAYOUT_FIELD(FShaderResourceParameter, HexagonPalette);
 };
 
 
@@ -41,8 +161,10 @@ FXkHexagonalWorldVertexFactory::FXkHexagonalWorldVertexFactory(ERHIFeatureLevel:
 	:FVertexFactory(InFeatureLevel)
 {
 	VertexPositionVertexBuffer = NULL;
-	InstancePositionVertexBuffer = NULL;
-	VertexPositionVertexBuffer = NULL;
+	InstanceVertexBuffer = NULL;
+	PaletteBuffer = NULL;
+	PaletteChannel = 0;
+	HexagonDistance = 0.0f;
 }
 
 
@@ -50,30 +172,30 @@ void FXkHexagonalWorldVertexFactory::InitRHI()
 {
 	FVertexDeclarationElementList Elements;
 
-	if (VertexPositionVertexBuffer && InstancePositionVertexBuffer && InstanceColorVertexBuffer)
+	if (VertexPositionVertexBuffer && InstanceVertexBuffer)
 	{
 		FVertexStreamComponent VertexPosStream(VertexPositionVertexBuffer, 0, sizeof(FVector4f), VET_Float4);
 
 		Elements.Add(AccessStreamComponent(VertexPosStream, 0));
 
-		FVertexStreamComponent PositionInstStream(InstancePositionVertexBuffer, 0, sizeof(FVector4f), VET_Float4, EVertexStreamUsage::Instancing);
+		// Both attributes read the one packed instance stream.
+		FVertexStreamComponent CoordInstStream(InstanceVertexBuffer, STRUCT_OFFSET(FXkHexagonInstance, CoordX), sizeof(FXkHexagonInstance), VET_Short4, EVertexStreamUsage::Instancing);
 
-		Elements.Add(AccessStreamComponent(PositionInstStream, 1));
+		Elements.Add(AccessStreamComponent(CoordInstStream, 1));
 
-		FVertexStreamComponent WeightInstStream(InstanceColorVertexBuffer, 0, sizeof(FVector4f), VET_Float4, EVertexStreamUsage::Instancing);
+		FVertexStreamComponent PaletteInstStream(InstanceVertexBuffer, STRUCT_OFFSET(FXkHexagonInstance, BaseColorIndex), sizeof(FXkHexagonInstance), VET_UByte4, EVertexStreamUsage::Instancing);
 
-		Elements.Add(AccessStreamComponent(WeightInstStream, 2));
+		Elements.Add(AccessStreamComponent(PaletteInstStream, 2));
 
 		InitDeclaration(Elements);
 	}
 }
 
 
-void FXkHexagonalWorldVertexFactory::SetVertexBuffer(FVertexBuffer* InData0, FVertexBuffer* InData1, FVertexBuffer* InData2)
+void FXkHexagonalWorldVertexFactory::SetVertexBuffer(FVertexBuffer* InData0, FVertexBuffer* InData1)
 {
 	VertexPositionVertexBuffer = InData0;
-	InstancePositionVertexBuffer = InData1;
-	InstanceColorVertexBuffer = InData2;
+	InstanceVertexBuffer = InData1;
 	UpdateRHI();
 }
 
@@ -110,6 +232,7 @@ IMPLEMENT_VERTEX_FACTORY_TYPE(FXkHexagonalWorldVertexFactory, "/Plugin/XkGamedev
 	| EVertexFactoryFlags::SupportsRayTracing
 	| EVertexFactoryFlags::SupportsRayTracingDynamicGeometry
 	| EVertexFactoryFlags::SupportsPSOPrecaching
+	| EVertexFactoryFlags::SupportsCachingMeshDrawCommands
 );
 
 
@@ -118,22 +241,33 @@ FXkHexagonalWorldSceneProxy::FXkHexagonalWorldSceneProxy(const UXkHexagonalWorld
 	:FPrimitiveSceneProxy(InComponent, ResourceName)
 	, MaterialRelevance(InComponent->GetMaterialRelevance(GetScene().GetFeatureLevel()))
 {
-	OwnerComponent = const_cast<UXkHexagonalWorldComponent*>(InComponent);
+	RenderChannel = InComponent->GetRenderChannel();
+	InstanceCapacity = 0;
+	InstanceNum = 0;
+	InstanceBufferUsedBytes = 0;
+	HexagonDistance = InComponent->Radius + InComponent->GapWidth;
+	bShowBaseMesh = InComponent->bShowBaseMesh;
+	bShowEdgeMesh = InComponent->bShowEdgeMesh;
+	bStaticDraw = HexagonStaticDraw != 0 && HexagonSortChunks == 0;
+	bStaticMeshesDirty = false;
+	bEdgeLOD = HexagonEdgeLOD != 0;
+	bSortChunks = HexagonSortChunks != 0;
+	bInstanceSyncPending = true;
+	Palette.Add(FVector4f(1.0));
+	bPaletteDirty = true;
+	bPaletteRebuilding = false;
+	PaletteRebuildNum = 0;
 	BaseMaterialRenderProxy = InBaseMaterialRenderProxy;
 	EdgeMaterialRenderProxy = InEdgeMaterialRenderProxy;
 	BaseVertexFactory = new FXkHexagonalWorldVertexFactory(GetScene().GetFeatureLevel());
 	EdgeVertexFactory = new FXkHexagonalWorldVertexFactory(GetScene().GetFeatureLevel());
+	HexagonalWorldSnapshot = InComponent->GetHexagonalWorldSnapshot();
+	HexagonHighlights = InComponent->GetHexagonHighlights();
 
-	BuildHexagon(HexagonData.BaseVertices, HexagonData.BaseIndices, HexagonData.EdgeVertices, HexagonData.EdgeIndices,
-		OwnerComponent->Radius, OwnerComponent->Height, OwnerComponent->BaseInnerGap, OwnerComponent->BaseOuterGap, OwnerComponent->EdgeInnerGap, OwnerComponent->EdgeOuterGap);
+	Geometry = FXkHexagonGeometryCache::Get(InComponent->GetHexagonGeometryKey());
 
 	// Enqueue initialization of render resource
-	BeginInitResource(&VertexPositionBuffer_GPU);
-	BeginInitResource(&InstancePositionBuffer_GPU);
-	BeginInitResource(&InstanceBaseColorBuffer_GPU);
-	BeginInitResource(&InstanceEdgeColorBuffer_GPU);
-	BeginInitResource(&BaseIndexBuffer_GPU);
-	BeginInitResource(&EdgeIndexBuffer_GPU);
+	BeginInitResource(&InstanceBuffer_GPU);
 
 	GenerateBuffers();
 }
@@ -143,67 +277,54 @@ FXkHexagonalWorldSceneProxy::~FXkHexagonalWorldSceneProxy()
 {
 	check(IsInRenderingThread());
 
+	FCoreDelegates::OnBeginFrameRT.Remove(BeginFrameHandle);
+	RenderChannel.Reset();
+
 	BaseVertexFactory->ReleaseResource();
 	EdgeVertexFactory->ReleaseResource();
 
-	VertexPositionBuffer_GPU.ReleaseResource();
-	InstancePositionBuffer_GPU.ReleaseResource();
-	InstanceBaseColorBuffer_GPU.ReleaseResource();
-	InstanceEdgeColorBuffer_GPU.ReleaseResource();
-	BaseIndexBuffer_GPU.ReleaseResource();
-	EdgeIndexBuffer_GPU.ReleaseResource();
+	InstanceBuffer_GPU.ReleaseResource();
+	PaletteBuffer_GPU.Release();
+	Geometry.Reset();
+	DEC_MEMORY_STAT_BY(STAT_XkHexagonInstanceBuffersUsed, InstanceBufferUsedBytes);
+	DEC_MEMORY_STAT_BY(STAT_XkHexagonInstanceBuffersAllocated, InstanceCapacity * HexagonInstanceBytes);
 
-	OwnerComponent = nullptr;
 	BaseVertexFactory = nullptr;
 	EdgeVertexFactory = nullptr;
 }
 
 
-//void FXkHexagonalWorldSceneProxy::DrawStaticElements(FStaticPrimitiveDrawInterface* PDI)
-//{
-//	FMeshBatch MeshBatch;
-//	MeshBatch.LODIndex = 0;
-//	MeshBatch.SegmentIndex = 0;
-//
-//	MeshBatch.VertexFactory = BaseVertexFactory;
-//	MeshBatch.Type = PT_TriangleList;
-//
-//	MeshBatch.LODIndex = 0;
-//	MeshBatch.SegmentIndex = 0;
-//
-//	MeshBatch.bDitheredLODTransition = false;
-//	MeshBatch.bWireframe = false;
-//	MeshBatch.CastShadow = false;
-//	MeshBatch.bUseForDepthPass = false;
-//	MeshBatch.bUseAsOccluder = false;
-//	MeshBatch.bUseForMaterial = false;
-//	MeshBatch.bRenderToVirtualTexture = true;
-//	MeshBatch.RuntimeVirtualTextureMaterialType = (int32)ERuntimeVirtualTextureMaterialType::BaseColor;
-//	MeshBatch.MaterialRenderProxy = BaseMaterialRenderProxy;
-//	MeshBatch.ReverseCulling = IsLocalToWorldDeterminantNegative();
-//
-//	MeshBatch.DepthPriorityGroup = SDPG_World;
-//	MeshBatch.bCanApplyViewModeOverrides = false;
-//
-//	MeshBatch.Elements.Empty(1);
-//	FMeshBatchElement BatchElement;
-//
-//	int32 NunInst = VisibleNodes.Num();
-//
-//	BatchElement.NumInstances = NunInst;
-//	BatchElement.IndexBuffer = &BaseIndexBuffer_GPU;
-//
-//	// We need the uniform buffer of this primitive because it stores the proper value for the bOutputVelocity flag.
-//	// The identity primitive uniform buffer simply stores false for this flag which leads to missing motion vectors.
-//	BatchElement.PrimitiveUniformBuffer = GetUniformBuffer();
-//
-//	BatchElement.FirstIndex = 0;
-//	BatchElement.NumPrimitives = BaseIndexBuffer_GPU.IndexBufferRHI->GetSize() / (3 * sizeof(uint32));
-//	BatchElement.MinVertexIndex = 0;
-//	BatchElement.MaxVertexIndex = HexagonData.BaseVertices.Num() - 1;
-//
-//	PDI->DrawMesh(MeshBatch, FLT_MAX);
-//}
+void FXkHexagonalWorldSceneProxy::DrawStaticElements(FStaticPrimitiveDrawInterface* PDI)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FXkHexagonalWorldSceneProxy::DrawStaticElements);
+
+	bStaticMeshesDirty = false;
+	if (!bStaticDraw)
+	{
+		return;
+	}
+	// Only single element batches are cached, one element covers every slot. Free slots hold zero scale instances and
+	// draw nothing, so the command is cached again only when the slots or the buffer change, not per instance or highlight.
+	if (SlotCoords.Num() == 0)
+	{
+		return;
+	}
+	TArray<FInstanceRun, TInlineAllocator<64>> Runs;
+	Runs.Add(FInstanceRun(0, SlotCoords.Num()));
+	if (bShowBaseMesh)
+	{
+		FMeshBatch Mesh;
+		SetupHexagonMesh(false, 0, Runs, Mesh);
+		PDI->DrawMesh(Mesh, FLT_MAX);
+	}
+	// Edges with LOD depend on the view, GetDynamicMeshElements draws them.
+	if (bShowEdgeMesh && !bEdgeLOD)
+	{
+		FMeshBatch Mesh;
+		SetupHexagonMesh(true, 0, Runs, Mesh);
+		PDI->DrawMesh(Mesh, FLT_MAX);
+	}
+}
 
 
 SIZE_T FXkHexagonalWorldSceneProxy::GetTypeHash() const
@@ -235,99 +356,243 @@ void FXkHexagonalWorldSceneProxy::GetDynamicMeshElements(const TArray<const FSce
 		Collector.RegisterOneFrameMaterialProxy(WireframeMaterialInstance);
 	}
 
-	const bool bShowBaseMesh = OwnerComponent->bShowBaseMesh;
-	const bool bShowEdgeMesh = OwnerComponent->bShowEdgeMesh;
+	auto AddHexagonMesh = [&](const int32 ViewIndex, const bool bEdge, const int32 InEdgeLOD, const TArray<FInstanceRun, TInlineAllocator<64>>& InRuns)
+		{
+			FMeshBatch& Mesh = Collector.AllocateMesh();
+			SetupHexagonMesh(bEdge, InEdgeLOD, InRuns, Mesh);
+			Mesh.bWireframe = bWireframe;
+			Mesh.bUseWireframeSelectionColoring = IsSelected();
+			if (WireframeMaterialInstance != nullptr)
+			{
+				Mesh.MaterialRenderProxy = WireframeMaterialInstance;
+			}
+
+			TRACE_CPUPROFILER_EVENT_SCOPE(Collector.AddMesh);
+			Collector.AddMesh(ViewIndex, Mesh);
+		};
 
 	for (int32 ViewIndex = 0; ViewIndex < Views.Num(); ViewIndex++)
 	{
-		const FSceneView& View = *Views[ViewIndex];
-		int16 FrameTag = View.GetOcclusionFrameCounter() % 65535;
-		FVector Position = GetActorPosition();
-
-		const_cast<FXkHexagonalWorldSceneProxy*>(this)->UpdateInstanceBuffer(FrameTag);
-		int32 NunInst = VisibleNodes.Num();
-		if (NunInst > 0)
+		if (!(VisibilityMap & (1 << ViewIndex)))
+		{
+			continue;
+		}
+		// The instance buffers are updated when the snapshot or the highlights change, only the chunks are culled per view.
+		TArray<FInstanceRun, TInlineAllocator<64>> Runs;
+		GetInstanceRuns(Views[ViewIndex], Runs);
+		if (Runs.Num() > 0)
 		{
 			// Hexagon Base Mesh
-			if (bShowBaseMesh)
+			if (bShowBaseMesh && !bStaticDraw)
 			{
-				FMeshBatch& Mesh = Collector.AllocateMesh();
-				Mesh.bWireframe = bWireframe;
-				Mesh.bUseForMaterial = true;
-				Mesh.bUseWireframeSelectionColoring = IsSelected();
-				Mesh.VertexFactory = BaseVertexFactory;
-				Mesh.MaterialRenderProxy = (WireframeMaterialInstance != nullptr) ? WireframeMaterialInstance : BaseMaterialRenderProxy;
-				Mesh.ReverseCulling = IsLocalToWorldDeterminantNegative();
-				Mesh.Type = PT_TriangleList;
-				Mesh.DepthPriorityGroup = SDPG_World;
-				Mesh.bCanApplyViewModeOverrides = false;
-				Mesh.bRenderToVirtualTexture = true;
-				Mesh.RuntimeVirtualTextureMaterialType = (int32)ERuntimeVirtualTextureMaterialType::BaseColor;
-
-				FMeshBatchElement& BatchElement = Mesh.Elements[0];
-				BatchElement.NumInstances = NunInst;
-				BatchElement.IndexBuffer = &BaseIndexBuffer_GPU;
-
-				// We need the uniform buffer of this primitive because it stores the proper value for the bOutputVelocity flag.
-				// The identity primitive uniform buffer simply stores false for this flag which leads to missing motion vectors.
-				BatchElement.PrimitiveUniformBuffer = GetUniformBuffer();
-
-				BatchElement.FirstIndex = 0;
-				BatchElement.NumPrimitives = BaseIndexBuffer_GPU.IndexBufferRHI->GetSize() / (3 * sizeof(uint32));
-				BatchElement.MinVertexIndex = 0;
-				BatchElement.MaxVertexIndex = HexagonData.BaseVertices.Num() - 1;
-
-				TRACE_CPUPROFILER_EVENT_SCOPE(Collector.AddMesh);
-				Collector.AddMesh(ViewIndex, Mesh);
+				AddHexagonMesh(ViewIndex, false, 0, Runs);
 			}
 
-			// Hexagon Edge Mesh
-			if (bShowEdgeMesh)
+			// Hexagon Edge Mesh, one mesh per LOD with edges
+			if (bShowEdgeMesh && (!bStaticDraw || bEdgeLOD))
 			{
-				FMeshBatch& Mesh = Collector.AllocateMesh();
-				Mesh.bWireframe = bWireframe;
-				Mesh.bUseForMaterial = true;
-				Mesh.bUseWireframeSelectionColoring = IsSelected();
-				Mesh.VertexFactory = EdgeVertexFactory;
-				Mesh.MaterialRenderProxy = (WireframeMaterialInstance != nullptr) ? WireframeMaterialInstance : EdgeMaterialRenderProxy;
-				Mesh.ReverseCulling = IsLocalToWorldDeterminantNegative();
-				Mesh.Type = PT_TriangleList;
-				Mesh.DepthPriorityGroup = SDPG_World;
-				Mesh.bCanApplyViewModeOverrides = false;
-				Mesh.bRenderToVirtualTexture = true;
-				Mesh.RuntimeVirtualTextureMaterialType = (int32)ERuntimeVirtualTextureMaterialType::BaseColor;
-
-				FMeshBatchElement& BatchElement = Mesh.Elements[0];
-				BatchElement.NumInstances = NunInst;
-				BatchElement.IndexBuffer = &EdgeIndexBuffer_GPU;
-
-				// We need the uniform buffer of this primitive because it stores the proper value for the bOutputVelocity flag.
-				// The identity primitive uniform buffer simply stores false for this flag which leads to missing motion vectors.
-				BatchElement.PrimitiveUniformBuffer = GetUniformBuffer();
-
-				BatchElement.FirstIndex = 0;
-				BatchElement.NumPrimitives = EdgeIndexBuffer_GPU.IndexBufferRHI->GetSize() / (3 * sizeof(uint32));
-				BatchElement.BaseVertexIndex = HexagonData.BaseVertices.Num();
-				BatchElement.MinVertexIndex = HexagonData.BaseVertices.Num();
-				BatchElement.MaxVertexIndex = HexagonData.BaseVertices.Num() + HexagonData.EdgeVertices.Num() - 1;
-
-				TRACE_CPUPROFILER_EVENT_SCOPE(Collector.AddMesh);
-				Collector.AddMesh(ViewIndex, Mesh);
+				TArray<FInstanceRun, TInlineAllocator<64>> EdgeRuns;
+				for (int32 EdgeLOD = 0; EdgeLOD < HEXAGON_EDGE_LOD_NUM - 1; EdgeLOD++)
+				{
+					EdgeRuns.Reset();
+					for (const FInstanceRun& Run : Runs)
+					{
+						if (Run.EdgeLOD == EdgeLOD)
+						{
+							EdgeRuns.Add(Run);
+						}
+					}
+					if (EdgeRuns.Num() > 0)
+					{
+						AddHexagonMesh(ViewIndex, true, EdgeLOD, EdgeRuns);
+					}
+				}
 			}
 		}
 	}
 }
 
 
+void FXkHexagonalWorldSceneProxy::GetInstanceRuns(const FSceneView* InView, TArray<FInstanceRun, TInlineAllocator<64>>& OutRuns) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FXkHexagonalWorldSceneProxy::GetInstanceRuns);
+
+	// Depth keys are taken in the culling pass, the bounds are transformed only once.
+	const bool bSort = InView && bSortChunks;
+	const FVector ViewOrigin = InView ? InView->ViewMatrices.GetViewOrigin() : FVector::ZeroVector;
+	const FVector ViewDirection = InView ? InView->GetViewDirection() : FVector::ForwardVector;
+	TArray<FXkVisibleHexagonChunk, TInlineAllocator<64>> VisibleChunks;
+	const FMatrix& LocalToWorld = GetLocalToWorld();
+	for (int32 Block = 0; Block < InstanceChunks.Num(); Block++)
+	{
+		const FInstanceChunk& Chunk = InstanceChunks[Block];
+		if (Chunk.Num == 0)
+		{
+			continue;
+		}
+		FXkVisibleHexagonChunk VisibleChunk;
+		VisibleChunk.DepthKey = 0;
+		VisibleChunk.Block = Block;
+		VisibleChunk.EdgeLOD = 0;
+		if (InView)
+		{
+			const FBox WorldBounds = Chunk.Bounds.TransformBy(LocalToWorld);
+			if (!InView->ViewFrustum.IntersectBox(WorldBounds.GetCenter(), WorldBounds.GetExtent()))
+			{
+				continue;
+			}
+			if (bEdgeLOD)
+			{
+				VisibleChunk.EdgeLOD = GetEdgeLOD(*InView, Chunk, WorldBounds);
+			}
+			if (bSort)
+			{
+				VisibleChunk.DepthKey = GetSortableDepthKey(FVector::DotProduct(WorldBounds.GetCenter() - ViewOrigin, ViewDirection));
+			}
+		}
+		VisibleChunks.Add(VisibleChunk);
+	}
+	if (bEdgeLOD && InView)
+	{
+		// A culled neighbour draws no edges, the same as LOD2.
+		TArray<int32, TInlineAllocator<256>> BlockEdgeLODs;
+		BlockEdgeLODs.Init(HEXAGON_EDGE_LOD_NUM - 1, InstanceChunks.Num());
+		for (const FXkVisibleHexagonChunk& VisibleChunk : VisibleChunks)
+		{
+			BlockEdgeLODs[VisibleChunk.Block] = VisibleChunk.EdgeLOD;
+		}
+		for (FXkVisibleHexagonChunk& VisibleChunk : VisibleChunks)
+		{
+			if (VisibleChunk.EdgeLOD == 1 && !CanUseHalfEdgeRing(InstanceChunks[VisibleChunk.Block], BlockEdgeLODs))
+			{
+				VisibleChunk.EdgeLOD = 0;
+			}
+		}
+	}
+	if (bSort)
+	{
+		RadixSortVisibleChunks(VisibleChunks);
+	}
+
+	for (const FXkVisibleHexagonChunk& VisibleChunk : VisibleChunks)
+	{
+		// Full blocks run on into the next one.
+		const int32 FirstSlot = VisibleChunk.Block * HEXAGON_INSTANCE_BLOCK_SIZE;
+		const int32 SlotNum = InstanceChunks[VisibleChunk.Block].Num;
+		if (OutRuns.Num() > 0 && OutRuns.Last().FirstSlot + OutRuns.Last().SlotNum == FirstSlot && OutRuns.Last().EdgeLOD == VisibleChunk.EdgeLOD)
+		{
+			OutRuns.Last().SlotNum += SlotNum;
+		}
+		else
+		{
+			OutRuns.Add(FInstanceRun(FirstSlot, SlotNum, VisibleChunk.EdgeLOD));
+		}
+	}
+}
+
+
+int32 FXkHexagonalWorldSceneProxy::GetEdgeLOD(const FSceneView& InView, const FInstanceChunk& InChunk, const FBox& InWorldBounds) const
+{
+	const FVector ViewOrigin = InView.ViewMatrices.GetViewOrigin();
+	const float HexagonRadius = Geometry->GetKey().Radius * InChunk.MaxScale * GetLocalToWorld().GetMaximumAxisScale();
+	const float ScreenSize = ComputeBoundsScreenSize(FVector4(InWorldBounds.GetClosestPointTo(ViewOrigin), 1.0), HexagonRadius, InView);
+	if (ScreenSize >= HexagonEdgeLOD1ScreenSize)
+	{
+		return 0;
+	}
+	return ScreenSize >= HexagonEdgeLOD2ScreenSize ? 1 : 2;
+}
+
+
+bool FXkHexagonalWorldSceneProxy::CanUseHalfEdgeRing(const FInstanceChunk& InChunk, const TArray<int32, TInlineAllocator<256>>& InBlockEdgeLODs) const
+{
+	// LOD1 draws the first 3 sides, the neighbour across each other side draws the one facing it.
+	// A missing node inside the page, or a neighbour page without nodes, leaves those sides open.
+	if (InChunk.bEdgeHighlighted || InChunk.Num < HEXAGON_INSTANCE_BLOCK_SIZE)
+	{
+		return false;
+	}
+	// Axial neighbours of a hexagon lie in these 6 pages around its own.
+	static const FIntPoint NeighbourPageOffsets[] = {
+		FIntPoint(1, 0), FIntPoint(-1, 0), FIntPoint(0, 1), FIntPoint(0, -1), FIntPoint(1, -1), FIntPoint(-1, 1) };
+	for (const FIntPoint& Offset : NeighbourPageOffsets)
+	{
+		const int32* NeighbourBlock = PageBlocks.Find(InChunk.PageKey + Offset);
+		if (!NeighbourBlock || InBlockEdgeLODs[*NeighbourBlock] > 1)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+
+void FXkHexagonalWorldSceneProxy::SetupHexagonMesh(const bool bEdge, const int32 InEdgeLOD, const TArray<FInstanceRun, TInlineAllocator<64>>& InRuns, FMeshBatch& OutMesh) const
+{
+	OutMesh.LODIndex = InEdgeLOD;
+	OutMesh.SegmentIndex = 0;
+	OutMesh.bUseForMaterial = true;
+	OutMesh.bUseForDepthPass = false;
+	OutMesh.VertexFactory = bEdge ? EdgeVertexFactory : BaseVertexFactory;
+	OutMesh.MaterialRenderProxy = bEdge ? EdgeMaterialRenderProxy : BaseMaterialRenderProxy;
+	OutMesh.ReverseCulling = IsLocalToWorldDeterminantNegative();
+	OutMesh.Type = PT_TriangleList;
+	OutMesh.DepthPriorityGroup = SDPG_World;
+	OutMesh.bCanApplyViewModeOverrides = false;
+	OutMesh.bRenderToVirtualTexture = true;
+	OutMesh.RuntimeVirtualTextureMaterialType = (int32)ERuntimeVirtualTextureMaterialType::BaseColor;
+
+	// Element template of the base or edge mesh, one element per run of instances is added from it.
+	FMeshBatchElement TemplateElement;
+	TemplateElement.IndexBuffer = bEdge ? Geometry->GetEdgeIndexBuffer() : Geometry->GetBaseIndexBuffer();
+
+	// We need the uniform buffer of this primitive because it stores the proper value for the bOutputVelocity flag.
+	// The identity primitive uniform buffer simply stores false for this flag which leads to missing motion vectors.
+	TemplateElement.PrimitiveUniformBuffer = GetUniformBuffer();
+
+	TemplateElement.FirstIndex = 0;
+	if (bEdge)
+	{
+		TemplateElement.NumPrimitives = (InEdgeLOD > 0 ? HEXAGON_EDGE_LOD1_INDEX_NUM : HEXAGON_EDGE_INDEX_NUM) / 3;
+		TemplateElement.BaseVertexIndex = HEXAGON_BASE_VERTEX_NUM;
+		TemplateElement.MinVertexIndex = HEXAGON_BASE_VERTEX_NUM;
+		TemplateElement.MaxVertexIndex = HEXAGON_BASE_VERTEX_NUM + HEXAGON_EDGE_VERTEX_NUM - 1;
+	}
+	else
+	{
+		TemplateElement.NumPrimitives = HEXAGON_BASE_INDEX_NUM / 3;
+		TemplateElement.MinVertexIndex = 0;
+		TemplateElement.MaxVertexIndex = HEXAGON_BASE_VERTEX_NUM - 1;
+	}
+
+	OutMesh.Elements.Reset(InRuns.Num());
+	for (const FInstanceRun& Run : InRuns)
+	{
+		FMeshBatchElement& RunElement = OutMesh.Elements.Add_GetRef(TemplateElement);
+		RunElement.UserIndex = Run.FirstSlot;
+		RunElement.NumInstances = Run.SlotNum;
+	}
+}
+
+
 void FXkHexagonalWorldSceneProxy::CreateRenderThreadResources()
 {
 	TRACE_CPUPROFILER_EVENT_SCOPE(FXkQuadtreeSceneProxy::CreateRenderThreadResources);
 	check(IsInRenderingThread());
 
-	BaseVertexFactory->SetVertexBuffer(&VertexPositionBuffer_GPU, &InstancePositionBuffer_GPU, &InstanceBaseColorBuffer_GPU);
+	// Both factories draw the same instances, the edge reads the second palette index.
+	BaseVertexFactory->PaletteBuffer = &PaletteBuffer_GPU;
+	BaseVertexFactory->PaletteChannel = 0;
+	BaseVertexFactory->HexagonDistance = HexagonDistance;
+	BaseVertexFactory->SetVertexBuffer(Geometry->GetVertexBuffer(), &InstanceBuffer_GPU);
 	BaseVertexFactory->InitResource();
-	EdgeVertexFactory->SetVertexBuffer(&VertexPositionBuffer_GPU, &InstancePositionBuffer_GPU, &InstanceEdgeColorBuffer_GPU);
+	EdgeVertexFactory->PaletteBuffer = &PaletteBuffer_GPU;
+	EdgeVertexFactory->PaletteChannel = 1;
+	EdgeVertexFactory->HexagonDistance = HexagonDistance;
+	EdgeVertexFactory->SetVertexBuffer(Geometry->GetVertexBuffer(), &InstanceBuffer_GPU);
 	EdgeVertexFactory->InitResource();
+
+	BeginFrameHandle = FCoreDelegates::OnBeginFrameRT.AddRaw(this, &FXkHexagonalWorldSceneProxy::DrainRenderUpdates);
 }
 
 
@@ -336,8 +601,8 @@ FPrimitiveViewRelevance FXkHexagonalWorldSceneProxy::GetViewRelevance(const FSce
 	FPrimitiveViewRelevance Result;
 	Result.bDrawRelevance = IsShown(View);
 	Result.bShadowRelevance = IsShadowCast(View);
-	Result.bDynamicRelevance = true;
-	Result.bStaticRelevance = false;
+	Result.bDynamicRelevance = !bStaticDraw || (bEdgeLOD && bShowEdgeMesh);
+	Result.bStaticRelevance = bStaticDraw;
 	Result.bRenderInDepthPass = false; // don't draw hexagon into depth
 	Result.bRenderInMainPass = ShouldRenderInMainPass();
 	Result.bUsesLightingChannels = GetLightingChannelMask() != GetDefaultLightingChannelMask();
@@ -353,178 +618,533 @@ void FXkHexagonalWorldSceneProxy::GenerateBuffers()
 {
 	TRACE_CPUPROFILER_EVENT_SCOPE(FXkHexagonalWorldSceneProxy::GenerateBuffers);
 
-	if (HexagonData.BaseVertices.Num() && HexagonData.EdgeVertices.Num())
-	{
-		check(HexagonData.BaseIndices.Num());
-		check(HexagonData.EdgeIndices.Num());
-
-		FHexagonData* HexagonDataRef = new FHexagonData();
-		HexagonDataRef->BaseVertices = HexagonData.BaseVertices;
-		HexagonDataRef->BaseIndices = HexagonData.BaseIndices;
-		HexagonDataRef->EdgeVertices = HexagonData.EdgeVertices;
-		HexagonDataRef->EdgeIndices = HexagonData.EdgeIndices;
-
-		FXkHexagonalWorldSceneProxy* SceneProxy = this;
+	FXkHexagonalWorldSceneProxy* SceneProxy = this;
 
-		ENQUEUE_RENDER_COMMAND(GenerateBuffers)(
-			[HexagonDataRef, SceneProxy](FRHICommandListImmediate& RHICmdList)
-			{
-				SceneProxy->GenerateBuffers_Renderthread(RHICmdList, HexagonDataRef);
-				delete HexagonDataRef;
-			});
-	}
+	ENQUEUE_RENDER_COMMAND(GenerateBuffers)(
+		[SceneProxy](FRHICommandListImmediate& RHICmdList)
+		{
+			SceneProxy->GenerateBuffers_Renderthread(RHICmdList);
+		});
 }
 
 
-void FXkHexagonalWorldSceneProxy::GenerateBuffers_Renderthread(FRHICommandListImmediate& RHICmdList, FHexagonData* InHexagonData)
+void FXkHexagonalWorldSceneProxy::GenerateBuffers_Renderthread(FRHICommandListImmediate& RHICmdList)
 {
 	TRACE_CPUPROFILER_EVENT_SCOPE(FXkQuadtreeSceneProxy::GenerateBuffers_Renderthread);
 
 	check(IsInRenderingThread());
 
+	// The instance buffers are created for the first nodes of the snapshot and grow with them.
+	UpdateInstanceBuffer();
+}
+
+
+void FXkHexagonalWorldSceneProxy::DrainRenderUpdates()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FXkHexagonalWorldSceneProxy::DrainRenderUpdates);
+
 	check(IsInRenderingThread());
 
-	if (!InHexagonData->BaseVertices.Num() || !InHexagonData->EdgeVertices.Num())
+	if (!RenderChannel.IsValid())
+	{
+		return;
+	}
+	// Updates of several ticks are applied in order, the instances are synced and uploaded once.
+	bool bChanged = false;
+	FXkHexagonalWorldRenderUpdate Update;
+	while (RenderChannel->Dequeue(Update))
+	{
+		bChanged = true;
+		if (Update.Snapshot.IsValid())
+		{
+			HexagonalWorldSnapshot = MoveTemp(Update.Snapshot);
+		}
+		// A pending full sync diffs every page against the last snapshot anyway, the changes up to it are skipped.
+		bInstanceSyncPending |= Update.bFullSync;
+		if (!bInstanceSyncPending)
+		{
+			ApplyNodeChanges(Update.NodeChanges);
+		}
+		ApplyHighlightChanges(Update.HighlightChanges);
+		if (Update.bVisibilityChanged && (bShowBaseMesh != Update.bShowBaseMesh || bShowEdgeMesh != Update.bShowEdgeMesh))
+		{
+			bShowBaseMesh = Update.bShowBaseMesh;
+			bShowEdgeMesh = Update.bShowEdgeMesh;
+			bStaticMeshesDirty = true;
+		}
+	}
+	if (bChanged)
+	{
+		UpdateInstanceBuffer();
+	}
+}
+
+
+void FXkHexagonalWorldSceneProxy::ApplyHighlightChanges(const TArray<FXkHexagonHighlightChange>& InChanges)
+{
+	if (InChanges.Num() == 0)
+	{
 		return;
+	}
+	for (const FXkHexagonHighlightChange& Change : InChanges)
+	{
+		if (Change.bCleared)
+		{
+			HexagonHighlights.Remove(Change.Coord);
+		}
+		else
+		{
+			HexagonHighlights.Add(Change.Coord, Change.Highlight);
+		}
+		if (const int32* Slot = CoordSlots.Find(Change.Coord))
+		{
+			SetInstanceColors(*Slot);
+		}
+	}
+	// Without highlights every slot is back at index 0, the colors of earlier highlights can be dropped.
+	if (HexagonHighlights.Num() == 0)
+	{
+		Palette.SetNum(1);
+	}
+}
 
-	FRHIResourceCreateInfo CreateInfo(TEXT("QuadtreeSceneProxy"));
-
-	/** vertex buffer */
-	TArray<FVector4f> BaseAndEdgeVertices;
-	BaseAndEdgeVertices.Append(InHexagonData->BaseVertices);
-	BaseAndEdgeVertices.Append(InHexagonData->EdgeVertices);
-	int32 NumSourceVerts = BaseAndEdgeVertices.Num();
-	VertexPositionBuffer_GPU.VertexBufferRHI = RHICreateVertexBuffer(
-		NumSourceVerts * sizeof(FVector4f),
-		BUF_Static | BUF_ShaderResource, CreateInfo);
-	void* RawVertexBuffer = RHILockBuffer(
-		VertexPositionBuffer_GPU.VertexBufferRHI, 0,
-		VertexPositionBuffer_GPU.VertexBufferRHI->GetSize(),
-		RLM_WriteOnly);
-	FMemory::Memcpy((char*)RawVertexBuffer, &BaseAndEdgeVertices[0], NumSourceVerts * sizeof(FVector4f));
-	RHIUnlockBuffer(VertexPositionBuffer_GPU.VertexBufferRHI);
-
-	/** index buffer */
-	int32 NumSourceIndices = InHexagonData->BaseIndices.Num();
-	BaseIndexBuffer_GPU.IndexBufferRHI = RHICreateIndexBuffer(sizeof(uint32), sizeof(uint32) * NumSourceIndices, BUF_Static, CreateInfo);
-	/** index buffer */
-	void* RawBaseIndexBuffer = RHILockBuffer(
-		BaseIndexBuffer_GPU.IndexBufferRHI,
-		0, NumSourceIndices * sizeof(uint32),
-		RLM_WriteOnly);
-	FMemory::Memcpy((char*)RawBaseIndexBuffer, &InHexagonData->BaseIndices[0], NumSourceIndices * sizeof(uint32));
-	RHIUnlockBuffer(BaseIndexBuffer_GPU.IndexBufferRHI);
-
-	NumSourceIndices = InHexagonData->EdgeIndices.Num();
-	EdgeIndexBuffer_GPU.IndexBufferRHI = RHICreateIndexBuffer(sizeof(uint32), sizeof(uint32) * NumSourceIndices, BUF_Static, CreateInfo);
-	/** index buffer */
-	void* RawEdgeIndexBuffer = RHILockBuffer(
-		EdgeIndexBuffer_GPU.IndexBufferRHI,
-		0, NumSourceIndices * sizeof(uint32),
-		RLM_WriteOnly);
-	FMemory::Memcpy((char*)RawEdgeIndexBuffer, &InHexagonData->EdgeIndices[0], NumSourceIndices * sizeof(uint32));
-	RHIUnlockBuffer(EdgeIndexBuffer_GPU.IndexBufferRHI);
-
-	/** instance position */
-	InstancePositionBuffer_GPU.VertexBufferRHI = RHICreateVertexBuffer(
-		MAX_HEXAGON_NODE_COUNT * sizeof(FVector4f),
-		BUF_Dynamic | BUF_ShaderResource, CreateInfo);
-	void* RawInstancePositionBuffer = RHILockBuffer(
-		InstancePositionBuffer_GPU.VertexBufferRHI, 0,
-		InstancePositionBuffer_GPU.VertexBufferRHI->GetSize(),
-		RLM_WriteOnly);
-	FMemory::Memset((char*)RawInstancePositionBuffer, 0, MAX_HEXAGON_NODE_COUNT * sizeof(FVector4f));
-	RHIUnlockBuffer(InstancePositionBuffer_GPU.VertexBufferRHI);
-
-	/** instance base color, RGBA for vertex color */
-	InstanceBaseColorBuffer_GPU.VertexBufferRHI = RHICreateVertexBuffer(
-		MAX_HEXAGON_NODE_COUNT * sizeof(FVector4f),
-		BUF_Dynamic | BUF_ShaderResource, CreateInfo);
-	void* RawInstanceBaseColorBuffer = RHILockBuffer(
-		InstanceBaseColorBuffer_GPU.VertexBufferRHI, 0,
-		InstanceBaseColorBuffer_GPU.VertexBufferRHI->GetSize(),
-		RLM_WriteOnly);
-	FMemory::Memset((char*)RawInstanceBaseColorBuffer, 0, MAX_HEXAGON_NODE_COUNT * sizeof(FVector4f));
-	RHIUnlockBuffer(InstanceBaseColorBuffer_GPU.VertexBufferRHI);
-
-	/** instance edge color, RGBA for vertex color */
-	InstanceEdgeColorBuffer_GPU.VertexBufferRHI = RHICreateVertexBuffer(
-		MAX_HEXAGON_NODE_COUNT * sizeof(FVector4f),
-		BUF_Dynamic | BUF_ShaderResource, CreateInfo);
-	void* RawInstanceEdgeColorBuffer = RHILockBuffer(
-		InstanceEdgeColorBuffer_GPU.VertexBufferRHI, 0,
-		InstanceEdgeColorBuffer_GPU.VertexBufferRHI->GetSize(),
-		RLM_WriteOnly);
-	FMemory::Memset((char*)RawInstanceEdgeColorBuffer, 0, MAX_HEXAGON_NODE_COUNT * sizeof(FVector4f));
-	RHIUnlockBuffer(InstanceEdgeColorBuffer_GPU.VertexBufferRHI);
-}
-
-
-void FXkHexagonalWorldSceneProxy::UpdateInstanceBuffer(const int16 InFrameTag)
-{
-	TRACE_CPUPROFILER_EVENT_SCOPE(FXkQuadtreeSceneProxy::UpdateInstanceBuffer);
+
+void FXkHexagonalWorldSceneProxy::UpdateInstanceBuffer()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FXkHexagonalWorldSceneProxy::UpdateInstanceBuffer);
 
 	check(IsInRenderingThread());
 
-	/** instance pos buffer */
-	FRHIResourceCreateInfo CreateInfo(TEXT("UpdateInstanceBuffer"));
-	// @TODO Cull
-	TArray<FXkHexagonNode> AllHexagonalWorldNodes;
-	OwnerComponent->ModifyHexagonalWorldNodes().GenerateValueArray(AllHexagonalWorldNodes);
-	VisibleNodes.Empty();
-	for (int i = 0; i < AllHexagonalWorldNodes.Num(); i++)
+	if (bInstanceSyncPending)
+	{
+		bInstanceSyncPending = false;
+		SyncInstanceSnapshot();
+	}
+	UpdateInstanceChunkBounds();
+	if (ReserveInstanceBuffers(SlotCoords.Num()))
+	{
+		// Cached draw commands hold the old buffer.
+		bStaticMeshesDirty = true;
+		// New buffers hold nothing yet, every slot is uploaded.
+		DirtySlots.Reset();
+		if (SlotCoords.Num() > 0)
+		{
+			UploadInstances(0, SlotCoords.Num());
+		}
+	}
+	else
+	{
+		UploadDirtyInstances();
+	}
+	UploadPalette();
+
+	// Cached draw commands hold the runs of the chunks, the renderer asks for the static meshes again.
+	if (bStaticDraw && bStaticMeshesDirty && GetPrimitiveSceneInfo())
+	{
+		bStaticMeshesDirty = false;
+		GetScene().UpdateCachedRenderStates(this);
+	}
+
+	const int64 UsedBytes = InstanceNum * HexagonInstanceBytes;
+	INC_MEMORY_STAT_BY(STAT_XkHexagonInstanceBuffersUsed, UsedBytes);
+	DEC_MEMORY_STAT_BY(STAT_XkHexagonInstanceBuffersUsed, InstanceBufferUsedBytes);
+	InstanceBufferUsedBytes = UsedBytes;
+}
+
+
+bool FXkHexagonalWorldSceneProxy::ReserveInstanceBuffers(const int32 InInstanceNum)
+{
+	if (InInstanceNum <= InstanceCapacity)
+	{
+		return false;
+	}
+	// Grow geometrically, a world streaming in chunk by chunk reallocates only a few times.
+	const int32 NewCapacity = FMath::Min(FMath::Max3(InInstanceNum, InstanceCapacity * 2, MinHexagonInstanceCapacity), MAX_HEXAGON_NODE_COUNT);
+	FRHIResourceCreateInfo CreateInfo(TEXT("XkHexagonalWorldInstanceBuffer"));
+	InstanceBuffer_GPU.VertexBufferRHI = RHICreateVertexBuffer(NewCapacity * HexagonInstanceBytes, BUF_Dynamic | BUF_ShaderResource, CreateInfo);
+
+	INC_MEMORY_STAT_BY(STAT_XkHexagonInstanceBuffersAllocated, NewCapacity * HexagonInstanceBytes);
+	DEC_MEMORY_STAT_BY(STAT_XkHexagonInstanceBuffersAllocated, InstanceCapacity * HexagonInstanceBytes);
+	InstanceCapacity = NewCapacity;
+	return true;
+}
+
+
+static void PackHexagonInstance(const FXkHexagonNode& InNode, FXkHexagonInstance& OutInstance)
+{
+	// Axial coord, the third cube coord is -X-Y
+	OutInstance.CoordX = (int16)InNode.Coord.X;
+	OutInstance.CoordY = (int16)InNode.Coord.Y;
+	OutInstance.Height = InNode.Position.Z;
+	OutInstance.Scale = InNode.Position.W;
+	OutInstance.Splatmap = InNode.Splatmap;
+}
+
+
+void FXkHexagonalWorldSceneProxy::SetInstance(const FXkHexagonNode& InNode)
+{
+	if (InNode.Type == EXkHexagonType::Unavailable)
+	{
+		RemoveInstance(InNode.Coord);
+		return;
+	}
+	const int32* SlotPtr = CoordSlots.Find(InNode.Coord);
+	if (!SlotPtr)
+	{
+		const FIntPoint PageKey = FXkHexagonalWorldSnapshotPage::GetPageKey(InNode.Coord);
+		const int32* BlockPtr = PageBlocks.Find(PageKey);
+		const int32 Block = BlockPtr ? *BlockPtr : AllocateInstanceBlock(PageKey);
+		if (Block == INDEX_NONE)
+		{
+			return;
+		}
+		FInstanceChunk& Chunk = InstanceChunks[Block];
+		const int32 Slot = Block * HEXAGON_INSTANCE_BLOCK_SIZE + Chunk.Num;
+		Chunk.Num++;
+		Chunk.bBoundsDirty = true;
+		InstanceNum++;
+		SlotCoords[Slot] = InNode.Coord;
+		CoordSlots.Add(InNode.Coord, Slot);
+		Instances[Slot] = FXkHexagonInstance();
+		PackHexagonInstance(InNode, Instances[Slot]);
+		SetInstanceColors(Slot);
+		DirtySlots.Add(Slot);
+		return;
+	}
+	FXkHexagonInstance Instance = Instances[*SlotPtr];
+	PackHexagonInstance(InNode, Instance);
+	if (Instances[*SlotPtr] != Instance)
+	{
+		Instances[*SlotPtr] = Instance;
+		InstanceChunks[*SlotPtr / HEXAGON_INSTANCE_BLOCK_SIZE].bBoundsDirty = true;
+		DirtySlots.Add(*SlotPtr);
+	}
+}
+
+
+void FXkHexagonalWorldSceneProxy::RemoveInstance(const FIntVector& InCoord)
+{
+	int32 Slot = INDEX_NONE;
+	if (!CoordSlots.RemoveAndCopyValue(InCoord, Slot))
+	{
+		return;
+	}
+	const int32 Block = Slot / HEXAGON_INSTANCE_BLOCK_SIZE;
+	FInstanceChunk& Chunk = InstanceChunks[Block];
+	const int32 LastSlot = Block * HEXAGON_INSTANCE_BLOCK_SIZE + Chunk.Num - 1;
+	if (Slot != LastSlot)
+	{
+		SlotCoords[Slot] = SlotCoords[LastSlot];
+		Instances[Slot] = Instances[LastSlot];
+		CoordSlots.Add(SlotCoords[Slot], Slot);
+		DirtySlots.Add(Slot);
+	}
+	// The static draw covers free slots too, a zero scale instance draws nothing.
+	Instances[LastSlot] = FXkHexagonInstance();
+	DirtySlots.Add(LastSlot);
+	Chunk.Num--;
+	Chunk.bBoundsDirty = true;
+	InstanceNum--;
+	if (Chunk.Num == 0)
+	{
+		PageBlocks.Remove(Chunk.PageKey);
+		FreeBlocks.Add(Block);
+	}
+}
+
+
+int32 FXkHexagonalWorldSceneProxy::AllocateInstanceBlock(const FIntPoint& InPageKey)
+{
+	int32 Block = INDEX_NONE;
+	if (FreeBlocks.Num() > 0)
+	{
+		Block = FreeBlocks.Pop(false);
+	}
+	else
+	{
+		if ((InstanceChunks.Num() + 1) * HEXAGON_INSTANCE_BLOCK_SIZE > MAX_HEXAGON_NODE_COUNT)
+		{
+			return INDEX_NONE;
+		}
+		Block = InstanceChunks.AddDefaulted();
+		const int32 SlotNum = InstanceChunks.Num() * HEXAGON_INSTANCE_BLOCK_SIZE;
+		SlotCoords.SetNumZeroed(SlotNum);
+		Instances.SetNum(SlotNum);
+		// The static draw covers every slot, a new block needs it cached again.
+		bStaticMeshesDirty = true;
+	}
+	InstanceChunks[Block] = FInstanceChunk();
+	InstanceChunks[Block].PageKey = InPageKey;
+	PageBlocks.Add(InPageKey, Block);
+	return Block;
+}
+
+
+void FXkHexagonalWorldSceneProxy::UpdateInstanceChunkBounds()
+{
+	const FXkHexagonGeometryKey& GeometryKey = Geometry->GetKey();
+	for (int32 Block = 0; Block < InstanceChunks.Num(); Block++)
+	{
+		FInstanceChunk& Chunk = InstanceChunks[Block];
+		if (!Chunk.bBoundsDirty || Chunk.Num == 0)
+		{
+			continue;
+		}
+		Chunk.bBoundsDirty = false;
+		Chunk.Bounds = FBox(ForceInit);
+		Chunk.MaxScale = 0.0f;
+		Chunk.bEdgeHighlighted = false;
+		const int32 FirstSlot = Block * HEXAGON_INSTANCE_BLOCK_SIZE;
+		for (int32 Slot = FirstSlot; Slot < FirstSlot + Chunk.Num; Slot++)
+		{
+			// XYZ translate and W scales the hexagon, see XkVertexFactory.ush
+			const FVector4f Position = GetInstancePosition(Slot);
+			const FVector Translation(Position.X, Position.Y, Position.Z);
+			const FVector HexagonMin(-GeometryKey.Radius, -GeometryKey.Radius, 0.0);
+			const FVector HexagonMax(GeometryKey.Radius, GeometryKey.Radius, GeometryKey.Height + 1.0);
+			Chunk.Bounds += Translation + HexagonMin * Position.W;
+			Chunk.Bounds += Translation + HexagonMax * Position.W;
+			Chunk.MaxScale = FMath::Max(Chunk.MaxScale, Position.W);
+			Chunk.bEdgeHighlighted |= Instances[Slot].EdgeColorIndex != 0;
+		}
+	}
+}
+
+
+FVector4f FXkHexagonalWorldSceneProxy::GetInstancePosition(const int32 InSlot) const
+{
+	const FXkHexagonInstance& Instance = Instances[InSlot];
+	const float CoordX = Instance.CoordX;
+	const float CoordY = Instance.CoordY;
+	const float CoordZ = -CoordX - CoordY;
+	// Same layout as FXkHexagonalWorldGenerator::LayoutCell
+	return FVector4f(1.5f * HexagonDistance * CoordX, XkCos30 * HexagonDistance * (CoordZ - CoordY), Instance.Height.GetFloat(), Instance.Scale.GetFloat());
+}
+
+
+void FXkHexagonalWorldSceneProxy::SetInstanceColors(const int32 InSlot)
+{
+	const FXkHexagonHighlight* Highlight = HexagonHighlights.Find(SlotCoords[InSlot]);
+	const uint32 OldPaletteRebuildNum = PaletteRebuildNum;
+	const uint8 BaseColorIndex = Highlight ? FindPaletteIndex(Highlight->BaseColor) : 0;
+	const uint8 EdgeColorIndex = Highlight ? FindPaletteIndex(Highlight->EdgeColor) : 0;
+	if (PaletteRebuildNum != OldPaletteRebuildNum)
+	{
+		// The rebuild colored this slot as well, an index found before it may be stale.
+		return;
+	}
+	FXkHexagonInstance& Instance = Instances[InSlot];
+	if (Instance.BaseColorIndex != BaseColorIndex || Instance.EdgeColorIndex != EdgeColorIndex)
+	{
+		if (Instance.EdgeColorIndex != EdgeColorIndex)
+		{
+			InstanceChunks[InSlot / HEXAGON_INSTANCE_BLOCK_SIZE].bBoundsDirty = true;
+		}
+		Instance.BaseColorIndex = BaseColorIndex;
+		Instance.EdgeColorIndex = EdgeColorIndex;
+		DirtySlots.Add(InSlot);
+	}
+}
+
+
+uint8 FXkHexagonalWorldSceneProxy::FindPaletteIndex(const FVector4f& InColor)
+{
+	// Highlights use a handful of colors, a linear search is cheaper than hashing them.
+	int32 Index = Palette.Find(InColor);
+	if (Index != INDEX_NONE)
+	{
+		return (uint8)Index;
+	}
+	if (Palette.Num() >= HEXAGON_PALETTE_SIZE && !bPaletteRebuilding)
+	{
+		// Colors of cleared highlights stay in the palette until it is full.
+		RebuildPalette();
+		Index = Palette.Find(InColor);
+		if (Index != INDEX_NONE)
+		{
+			return (uint8)Index;
+		}
+	}
+	if (Palette.Num() < HEXAGON_PALETTE_SIZE)
+	{
+		bPaletteDirty = true;
+		return (uint8)Palette.Add(InColor);
+	}
+	// More colors in use than the palette holds.
+	float MinDistSquared = MAX_flt;
+	for (int32 i = 0; i < Palette.Num(); i++)
+	{
+		const float DistSquared = (Palette[i] - InColor).SizeSquared();
+		if (DistSquared < MinDistSquared)
+		{
+			MinDistSquared = DistSquared;
+			Index = i;
+		}
+	}
+	return (uint8)Index;
+}
+
+
+void FXkHexagonalWorldSceneProxy::RebuildPalette()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FXkHexagonalWorldSceneProxy::RebuildPalette);
+
+	bPaletteRebuilding = true;
+	PaletteRebuildNum++;
+	Palette.SetNum(1);
+	bPaletteDirty = true;
+	for (int32 Block = 0; Block < InstanceChunks.Num(); Block++)
+	{
+		const int32 FirstSlot = Block * HEXAGON_INSTANCE_BLOCK_SIZE;
+		for (int32 Slot = FirstSlot; Slot < FirstSlot + InstanceChunks[Block].Num; Slot++)
+		{
+			SetInstanceColors(Slot);
+		}
+	}
+	bPaletteRebuilding = false;
+}
+
+
+void FXkHexagonalWorldSceneProxy::SyncInstanceSnapshot()
+{
+	static const TMap<FIntPoint, FXkHexagonalWorldSnapshotPagePtr> NoPages;
+	const TMap<FIntPoint, FXkHexagonalWorldSnapshotPagePtr>& Pages = HexagonalWorldSnapshot.IsValid() ? HexagonalWorldSnapshot->Pages : NoPages;
+
+	for (auto It = MirroredPages.CreateIterator(); It; ++It)
+	{
+		if (!Pages.Contains(It.Key()))
+		{
+			for (const FXkHexagonNode& Node : It.Value()->Nodes)
+			{
+				RemoveInstance(Node.Coord);
+			}
+			It.RemoveCurrent();
+		}
+	}
+
+	// Snapshots share the pages that did not change, only replaced pages are visited.
+	for (const TPair<FIntPoint, FXkHexagonalWorldSnapshotPagePtr>& PagePair : Pages)
+	{
+		FXkHexagonalWorldSnapshotPagePtr& MirroredPage = MirroredPages.FindOrAdd(PagePair.Key);
+		if (MirroredPage == PagePair.Value)
+		{
+			continue;
+		}
+		if (MirroredPage.IsValid())
+		{
+			for (const FXkHexagonNode& Node : MirroredPage->Nodes)
+			{
+				if (!PagePair.Value->Find(Node.Coord))
+				{
+					RemoveInstance(Node.Coord);
+				}
+			}
+		}
+		for (const FXkHexagonNode& Node : PagePair.Value->Nodes)
+		{
+			SetInstance(Node);
+		}
+		MirroredPage = PagePair.Value;
+	}
+}
+
+
+void FXkHexagonalWorldSceneProxy::ApplyNodeChanges(const TArray<FXkHexagonNodeChange>& InChanges)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FXkHexagonalWorldSceneProxy::ApplyNodeChanges);
+
+	if (InChanges.Num() == 0 || !HexagonalWorldSnapshot.IsValid())
+	{
+		return;
+	}
+	// Custom data is not drawn, every other field ends up in the instance.
+	const EXkHexagonNodeField InstanceFields = ~EXkHexagonNodeField::CustomData;
+	TSet<FIntPoint, DefaultKeyFuncs<FIntPoint>, TInlineSetAllocator<16>> ChangedPages;
+	for (const FXkHexagonNodeChange& Change : InChanges)
 	{
-		const FXkHexagonNode& Node = AllHexagonalWorldNodes[i];
-		if (Node.Type == EXkHexagonType::Unavailable)
+		const FIntPoint PageKey = FXkHexagonalWorldSnapshotPage::GetPageKey(Change.Coord);
+		ChangedPages.Add(PageKey);
+		if (!EnumHasAnyFlags(Change.Fields, InstanceFields))
 		{
 			continue;
 		}
-		VisibleNodes.Add(Node.Coord);
+		if (const FXkHexagonNode* Node = HexagonalWorldSnapshot->Find(Change.Coord))
+		{
+			SetInstance(*Node);
+		}
+		else
+		{
+			RemoveInstance(Change.Coord);
+		}
 	}
+	// Every change of a page is in the journal, the mirror now holds the page of this snapshot.
+	for (const FIntPoint& PageKey : ChangedPages)
+	{
+		if (const FXkHexagonalWorldSnapshotPagePtr* Page = HexagonalWorldSnapshot->Pages.Find(PageKey))
+		{
+			MirroredPages.Add(PageKey, *Page);
+		}
+		else
+		{
+			MirroredPages.Remove(PageKey);
+		}
+	}
+}
 
-	if (VisibleNodes.Num() == 0)
+
+void FXkHexagonalWorldSceneProxy::UploadDirtyInstances()
+{
+	if (DirtySlots.Num() == 0)
 	{
 		return;
 	}
 
-	TArray<FVector4f> InstancePositionData;
-	TArray<FVector4f> InstanceBaseColorData;
-	TArray<FVector4f> InstanceEdgeColorData;
-
-	for (int i = 0; i < VisibleNodes.Num(); i++)
-	{
-		FIntVector Coord = VisibleNodes[i];
-		const FXkHexagonNode& Node = OwnerComponent->ModifyHexagonalWorldNodes()[Coord];
-		FVector4f InstancePositionValue = Node.Position;
-		FVector4f InstanceBaseColorValue = FVector4f(1.0);
-		FVector4f InstanceEdgeColorValue = FVector4f(1.0);
-
-		InstancePositionData.Add(InstancePositionValue);
-		InstanceBaseColorData.Add(InstanceBaseColorValue);
-		InstanceEdgeColorData.Add(InstanceEdgeColorValue);
-	}
-
-	/** instance position data */
-	void* RawInstancePositionData = RHILockBuffer(
-		InstancePositionBuffer_GPU.VertexBufferRHI, 0,
-		InstancePositionBuffer_GPU.VertexBufferRHI->GetSize(),
-		RLM_WriteOnly);
-	FMemory::Memcpy((char*)RawInstancePositionData, InstancePositionData.GetData(), InstancePositionData.Num() * sizeof(FVector4f));
-	RHIUnlockBuffer(InstancePositionBuffer_GPU.VertexBufferRHI);
-
-	/** instance base color data */
-	void* RawInstanceBaseColorData = RHILockBuffer(
-		InstanceBaseColorBuffer_GPU.VertexBufferRHI, 0,
-		InstanceBaseColorBuffer_GPU.VertexBufferRHI->GetSize(),
-		RLM_WriteOnly);
-	FMemory::Memcpy((char*)RawInstanceBaseColorData, InstanceBaseColorData.GetData(), InstanceBaseColorData.Num() * sizeof(FVector4f));
-	RHIUnlockBuffer(InstanceBaseColorBuffer_GPU.VertexBufferRHI);
-
-	/** instance edge color data */
-	void* RawInstanceEdgeColorData = RHILockBuffer(
-		InstanceEdgeColorBuffer_GPU.VertexBufferRHI, 0,
-		InstanceEdgeColorBuffer_GPU.VertexBufferRHI->GetSize(),
-		RLM_WriteOnly);
-	FMemory::Memcpy((char*)RawInstanceEdgeColorData, InstanceEdgeColorData.GetData(), InstanceEdgeColorData.Num() * sizeof(FVector4f));
-	RHIUnlockBuffer(InstanceEdgeColorBuffer_GPU.VertexBufferRHI);
-}
\ No newline at end of file
+	DirtySlots.Sort();
+	// Runs closer than this are uploaded as one, a lock per slot costs more than the bytes in between.
+	const int32 MaxSlotGap = 64;
+	TArray<TPair<int32, int32>, TInlineAllocator<16>> Runs;
+	for (const int32 Slot : DirtySlots)
+	{
+		if (Runs.Num() > 0 && Slot <= Runs.Last().Value + MaxSlotGap)
+		{
+			Runs.Last().Value = FMath::Max(Runs.Last().Value, Slot);
+		}
+		else
+		{
+			Runs.Add(TPair<int32, int32>(Slot, Slot));
+		}
+	}
+	DirtySlots.Reset();
+
+	for (const TPair<int32, int32>& Run : Runs)
+	{
+		UploadInstances(Run.Key, Run.Value - Run.Key + 1);
+	}
+}
+
+
+void FXkHexagonalWorldSceneProxy::UploadInstances(const int32 InFirstSlot, const int32 InSlotNum)
+{
+	void* RawData = RHILockBuffer(InstanceBuffer_GPU.VertexBufferRHI, InFirstSlot * HexagonInstanceBytes, InSlotNum * HexagonInstanceBytes, RLM_WriteOnly);
+	FMemory::Memcpy(RawData, &Instances[InFirstSlot], InSlotNum * HexagonInstanceBytes);
+	RHIUnlockBuffer(InstanceBuffer_GPU.VertexBufferRHI);
+}
+
+
+void FXkHexagonalWorldSceneProxy::UploadPalette()
+{
+	if (!PaletteBuffer_GPU.Buffer.IsValid())
+	{
+		// Room for every index, the entries past the palette are never read.
+		PaletteBuffer_GPU.Initialize(TEXT("XkHexagonalWorldPalette"), sizeof(FVector4f), HEXAGON_PALETTE_SIZE, PF_A32B32G32R32F, BUF_Dynamic);
+		bPaletteDirty = true;
+	}
+	if (!bPaletteDirty)
+	{
+		return;
+	}
+	bPaletteDirty = false;
+	void* RawData = RHILockBuffer(PaletteBuffer_GPU.Buffer, 0, Palette.Num() * sizeof(FVector4f), RLM_WriteOnly);
+	FMemory::Memcpy(RawData, Palette.GetData(), Palette.Num() * sizeof(FVector4f));
+	RHIUnlockBuffer(PaletteBuffer_GPU.Buffer);
+}
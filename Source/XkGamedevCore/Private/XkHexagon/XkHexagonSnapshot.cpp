@@ -0,0 +1,139 @@
+// Copyright ©ICEPRINCE. All Rights Reserved.
+
+
+#include "XkHexagon/XkHexagonSnapshot.h"
+
+
+FXkHexagonalWorldSnapshotPage::FXkHexagonalWorldSnapshotPage()
+{
+	for (int32 Index = 0; Index < HEXAGON_SNAPSHOT_PAGE_SIZE * HEXAGON_SNAPSHOT_PAGE_SIZE; Index++)
+	{
+		Slots[Index] = INDEX_NONE;
+	}
+}
+
+
+const FXkHexagonNode* FXkHexagonalWorldSnapshotPage::Find(const FIntVector& InCoord) const
+{
+	const int16 Slot = Slots[GetSlotIndex(InCoord)];
+	return (Slot != INDEX_NONE) ? &Nodes[Slot] : nullptr;
+}
+
+
+void FXkHexagonalWorldSnapshotPage::Add(const FXkHexagonNode& InNode)
+{
+	const int32 SlotIndex = GetSlotIndex(InNode.Coord);
+	if (Slots[SlotIndex] != INDEX_NONE)
+	{
+		Nodes[Slots[SlotIndex]] = InNode;
+		return;
+	}
+	Slots[SlotIndex] = (int16)Nodes.Add(InNode);
+}
+
+
+const FXkHexagonNode* FXkHexagonalWorldSnapshot::Find(const FIntVector& InCoord) const
+{
+	if (const FXkHexagonalWorldSnapshotPagePtr* Page = Pages.Find(FXkHexagonalWorldSnapshotPage::GetPageKey(InCoord)))
+	{
+		return (*Page)->Find(InCoord);
+	}
+	return nullptr;
+}
+
+
+void FXkHexagonalWorldNodeTable::MarkNodeDirty(const FIntVector& InCoord, const EXkHexagonNodeField InFields)
+{
+	ChangeJournal.Record(InCoord, InFields);
+	if (bAllPagesDirty)
+	{
+		return;
+	}
+	DirtyPages.FindOrAdd(FXkHexagonalWorldSnapshotPage::GetPageKey(InCoord)).AddUnique(InCoord);
+}
+
+
+void FXkHexagonalWorldNodeTable::MarkAllNodesDirty()
+{
+	bAllPagesDirty = true;
+	DirtyPages.Empty();
+	ChangeJournal.RecordReset();
+}
+
+
+TSharedRef<const FXkHexagonalWorldSnapshot, ESPMode::ThreadSafe> FXkHexagonalWorldNodeTable::PublishSnapshot()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FXkHexagonalWorldNodeTable::PublishSnapshot);
+
+	ChangeJournal.EndFrame();
+
+	if (LatestSnapshot.IsValid() && !bAllPagesDirty && DirtyPages.IsEmpty())
+	{
+		return LatestSnapshot.ToSharedRef();
+	}
+
+	TSharedRef<FXkHexagonalWorldSnapshot, ESPMode::ThreadSafe> Snapshot = MakeShared<FXkHexagonalWorldSnapshot, ESPMode::ThreadSafe>();
+	Snapshot->Version = ++SnapshotVersion;
+	if (bAllPagesDirty || !LatestSnapshot.IsValid())
+	{
+		TMap<FIntPoint, TSharedPtr<FXkHexagonalWorldSnapshotPage, ESPMode::ThreadSafe>> NewPages;
+		for (const TPair<FIntVector, FXkHexagonNode>& NodePair : Nodes)
+		{
+			TSharedPtr<FXkHexagonalWorldSnapshotPage, ESPMode::ThreadSafe>& Page = NewPages.FindOrAdd(FXkHexagonalWorldSnapshotPage::GetPageKey(NodePair.Key));
+			if (!Page.IsValid())
+			{
+				Page = MakeShared<FXkHexagonalWorldSnapshotPage, ESPMode::ThreadSafe>();
+			}
+			Page->Add(NodePair.Value);
+		}
+		Snapshot->Pages.Reserve(NewPages.Num());
+		for (const TPair<FIntPoint, TSharedPtr<FXkHexagonalWorldSnapshotPage, ESPMode::ThreadSafe>>& PagePair : NewPages)
+		{
+			Snapshot->Pages.Add(PagePair.Key, PagePair.Value);
+		}
+	}
+	else
+	{
+		// Copy on write, pages without dirty nodes are shared with the previous snapshot.
+		Snapshot->Pages = LatestSnapshot->Pages;
+		for (const TPair<FIntPoint, TArray<FIntVector>>& DirtyPair : DirtyPages)
+		{
+			TSharedRef<FXkHexagonalWorldSnapshotPage, ESPMode::ThreadSafe> NewPage = MakeShared<FXkHexagonalWorldSnapshotPage, ESPMode::ThreadSafe>();
+			if (const FXkHexagonalWorldSnapshotPagePtr* OldPage = Snapshot->Pages.Find(DirtyPair.Key))
+			{
+				for (const FXkHexagonNode& OldNode : (*OldPage)->Nodes)
+				{
+					if (!DirtyPair.Value.Contains(OldNode.Coord))
+					{
+						NewPage->Add(OldNode);
+					}
+				}
+			}
+			for (const FIntVector& Coord : DirtyPair.Value)
+			{
+				if (const FXkHexagonNode* Node = Nodes.Find(Coord))
+				{
+					NewPage->Add(*Node);
+				}
+			}
+			if (NewPage->Nodes.Num() > 0)
+			{
+				Snapshot->Pages.Add(DirtyPair.Key, NewPage);
+			}
+			else
+			{
+				Snapshot->Pages.Remove(DirtyPair.Key);
+			}
+		}
+	}
+
+	for (const TPair<FIntPoint, FXkHexagonalWorldSnapshotPagePtr>& PagePair : Snapshot->Pages)
+	{
+		Snapshot->NodeNum += PagePair.Value->Nodes.Num();
+	}
+
+	DirtyPages.Empty();
+	bAllPagesDirty = false;
+	LatestSnapshot = Snapshot;
+	return Snapshot;
+}
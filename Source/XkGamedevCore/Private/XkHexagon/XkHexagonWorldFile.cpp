@@ -0,0 +1,259 @@
+// Copyright ©ICEPRINCE. All Rights Reserved.
+
+
+#include "XkHexagon/XkHexagonWorldFile.h"
+#include "XkGamedevCore.h"
+#include "Async/MappedFileHandle.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/FileHelper.h"
+
+
+FXkHexagonalWorldFile::FXkHexagonalWorldFile() :
+	Data(nullptr),
+	DataSize(0)
+{
+}
+
+
+FXkHexagonalWorldFile::~FXkHexagonalWorldFile()
+{
+	Close();
+}
+
+
+bool FXkHexagonalWorldFile::Save(const FString& InFilename, const TMap<FIntVector, FXkHexagonNode>& InNodes, const float InRadius, const float InGapWidth)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FXkHexagonalWorldFile::Save);
+
+	int32 MaxManhattanDistance = 0;
+	for (const TPair<FIntVector, FXkHexagonNode>& NodePair : InNodes)
+	{
+		MaxManhattanDistance = FMath::Max(MaxManhattanDistance, FMath::Max(FMath::Abs(NodePair.Key.X), FMath::Abs(NodePair.Key.Y)));
+	}
+	const int32 Pitch = MaxManhattanDistance * 2 + 1;
+	const uint64 CellNum = (uint64)Pitch * (uint64)Pitch;
+
+	FXkHexagonalWorldFileHeader Header;
+	FMemory::Memzero(Header);
+	Header.Magic = HEXAGON_WORLD_FILE_MAGIC;
+	Header.Version = HEXAGON_WORLD_FILE_VERSION;
+	Header.MaxManhattanDistance = MaxManhattanDistance;
+	Header.Pitch = Pitch;
+	Header.NodeNum = InNodes.Num();
+	Header.Radius = InRadius;
+	Header.GapWidth = InGapWidth;
+	Header.TypeOffset = sizeof(FXkHexagonalWorldFileHeader);
+	Header.SplatOffset = Align(Header.TypeOffset + CellNum * sizeof(uint8), 16);
+	Header.PositionOffset = Align(Header.SplatOffset + CellNum * sizeof(uint8), 16);
+	Header.CustomDataOffset = Align(Header.PositionOffset + CellNum * sizeof(FVector4f), 16);
+	const uint64 FileSize = Header.CustomDataOffset + CellNum * sizeof(FVector4f);
+
+	TArray64<uint8> Buffer;
+	Buffer.SetNumZeroed(FileSize);
+	FMemory::Memcpy(Buffer.GetData(), &Header, sizeof(Header));
+	uint8* Types = Buffer.GetData() + Header.TypeOffset;
+	uint8* Splats = Buffer.GetData() + Header.SplatOffset;
+	FVector4f* Positions = reinterpret_cast<FVector4f*>(Buffer.GetData() + Header.PositionOffset);
+	FVector4f* CustomData = reinterpret_cast<FVector4f*>(Buffer.GetData() + Header.CustomDataOffset);
+	for (const TPair<FIntVector, FXkHexagonNode>& NodePair : InNodes)
+	{
+		const int32 CellIndex = (NodePair.Key.X + MaxManhattanDistance) * Pitch + (NodePair.Key.Y + MaxManhattanDistance);
+		Types[CellIndex] = (uint8)NodePair.Value.Type;
+		Splats[CellIndex] = NodePair.Value.Splatmap;
+		Positions[CellIndex] = NodePair.Value.Position;
+		CustomData[CellIndex] = NodePair.Value.CustomData;
+	}
+
+	if (!FFileHelper::SaveArrayToFile(Buffer, *InFilename))
+	{
+		UE_LOG(LogXkGamedevCore, Warning, TEXT("Failed to save hexagonal world file %s"), *InFilename);
+		return false;
+	}
+	return true;
+}
+
+
+bool FXkHexagonalWorldFile::Save(const FString& InFilename, const FXkHexagonalWorldGrid& InGrid)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FXkHexagonalWorldFile::Save);
+
+	const uint64 CellNum = (uint64)InGrid.Pitch * (uint64)InGrid.Pitch;
+
+	FXkHexagonalWorldFileHeader Header;
+	FMemory::Memzero(Header);
+	Header.Magic = HEXAGON_WORLD_FILE_MAGIC;
+	Header.Version = HEXAGON_WORLD_FILE_VERSION;
+	Header.MaxManhattanDistance = InGrid.MaxManhattanDistance;
+	Header.Pitch = InGrid.Pitch;
+	Header.NodeNum = InGrid.NodeCells.Num();
+	Header.Radius = InGrid.GeneratedSettings.Radius;
+	Header.GapWidth = InGrid.GeneratedSettings.GapWidth;
+	Header.TypeOffset = sizeof(FXkHexagonalWorldFileHeader);
+	Header.SplatOffset = Align(Header.TypeOffset + CellNum * sizeof(uint8), 16);
+	Header.PositionOffset = Align(Header.SplatOffset + CellNum * sizeof(uint8), 16);
+	Header.CustomDataOffset = Align(Header.PositionOffset + CellNum * sizeof(FVector4f), 16);
+	const uint64 FileSize = Header.CustomDataOffset + CellNum * sizeof(FVector4f);
+
+	TArray64<uint8> Buffer;
+	Buffer.SetNumZeroed(FileSize);
+	FMemory::Memcpy(Buffer.GetData(), &Header, sizeof(Header));
+	FMemory::Memcpy(Buffer.GetData() + Header.TypeOffset, InGrid.Types.GetData(), CellNum * sizeof(uint8));
+	FMemory::Memcpy(Buffer.GetData() + Header.SplatOffset, InGrid.Splats.GetData(), CellNum * sizeof(uint8));
+	FMemory::Memcpy(Buffer.GetData() + Header.PositionOffset, InGrid.Positions.GetData(), CellNum * sizeof(FVector4f));
+	FMemory::Memcpy(Buffer.GetData() + Header.CustomDataOffset, InGrid.CustomData.GetData(), CellNum * sizeof(FVector4f));
+
+	if (!FFileHelper::SaveArrayToFile(Buffer, *InFilename))
+	{
+		UE_LOG(LogXkGamedevCore, Warning, TEXT("Failed to save hexagonal world file %s"), *InFilename);
+		return false;
+	}
+	return true;
+}
+
+
+bool FXkHexagonalWorldFile::Open(const FString& InFilename)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FXkHexagonalWorldFile::Open);
+
+	Close();
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	MappedHandle.Reset(PlatformFile.OpenMapped(*InFilename));
+	if (MappedHandle.IsValid() && MappedHandle->GetFileSize() > 0)
+	{
+		MappedRegion.Reset(MappedHandle->MapRegion(0, MappedHandle->GetFileSize()));
+	}
+	if (MappedRegion.IsValid())
+	{
+		Data = MappedRegion->GetMappedPtr();
+		DataSize = MappedRegion->GetMappedSize();
+	}
+	else
+	{
+		MappedHandle.Reset();
+		if (FFileHelper::LoadFileToArray(LoadedData, *InFilename, FILEREAD_Silent))
+		{
+			Data = LoadedData.GetData();
+			DataSize = LoadedData.Num();
+		}
+	}
+
+	if (!Data || !Validate())
+	{
+		if (Data)
+		{
+			UE_LOG(LogXkGamedevCore, Warning, TEXT("Invalid hexagonal world file %s"), *InFilename);
+		}
+		Close();
+		return false;
+	}
+	return true;
+}
+
+
+void FXkHexagonalWorldFile::Close()
+{
+	MappedRegion.Reset();
+	MappedHandle.Reset();
+	LoadedData.Empty();
+	Data = nullptr;
+	DataSize = 0;
+}
+
+
+int32 FXkHexagonalWorldFile::GetCellIndex(const FIntVector& InCoord) const
+{
+	const FXkHexagonalWorldFileHeader& Header = GetHeader();
+	if (FMath::Abs(InCoord.X) > Header.MaxManhattanDistance || FMath::Abs(InCoord.Y) > Header.MaxManhattanDistance)
+	{
+		return INDEX_NONE;
+	}
+	return (InCoord.X + Header.MaxManhattanDistance) * Header.Pitch + (InCoord.Y + Header.MaxManhattanDistance);
+}
+
+
+bool FXkHexagonalWorldFile::GetNode(const FIntVector& InCoord, FXkHexagonNode& OutNode) const
+{
+	const int32 CellIndex = GetCellIndex(InCoord);
+	if (CellIndex == INDEX_NONE || GetTypes()[CellIndex] == 0)
+	{
+		return false;
+	}
+	OutNode = MakeNode(CellIndex, InCoord);
+	return true;
+}
+
+
+void FXkHexagonalWorldFile::FillNodes(TMap<FIntVector, FXkHexagonNode>& OutNodes) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FXkHexagonalWorldFile::FillNodes);
+
+	const FXkHexagonalWorldFileHeader& Header = GetHeader();
+	const uint8* Types = GetTypes();
+	OutNodes.Empty(Header.NodeNum);
+	for (int32 X = -Header.MaxManhattanDistance; X <= Header.MaxManhattanDistance; X++)
+	{
+		const int32 RowIndex = (X + Header.MaxManhattanDistance) * Header.Pitch;
+		for (int32 Y = -Header.MaxManhattanDistance; Y <= Header.MaxManhattanDistance; Y++)
+		{
+			const int32 CellIndex = RowIndex + Y + Header.MaxManhattanDistance;
+			if (Types[CellIndex] == 0)
+			{
+				continue;
+			}
+			const FIntVector Coord = FIntVector(X, Y, -X - Y);
+			OutNodes.Add(Coord, MakeNode(CellIndex, Coord));
+		}
+	}
+}
+
+
+void FXkHexagonalWorldFile::FillGrid(FXkHexagonalWorldGrid& OutGrid) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FXkHexagonalWorldFile::FillGrid);
+
+	const FXkHexagonalWorldFileHeader& Header = GetHeader();
+	const int32 CellNum = Header.Pitch * Header.Pitch;
+	OutGrid.Allocate(Header.MaxManhattanDistance);
+	FMemory::Memcpy(OutGrid.Types.GetData(), GetTypes(), CellNum * sizeof(uint8));
+	FMemory::Memcpy(OutGrid.Splats.GetData(), GetSplats(), CellNum * sizeof(uint8));
+	FMemory::Memcpy(OutGrid.Positions.GetData(), GetPositions(), CellNum * sizeof(FVector4f));
+	FMemory::Memcpy(OutGrid.CustomData.GetData(), GetCustomData(), CellNum * sizeof(FVector4f));
+	OutGrid.NodeCells.Reset(Header.NodeNum);
+	for (int32 CellIndex = 0; CellIndex < CellNum; CellIndex++)
+	{
+		if (OutGrid.Types[CellIndex] != 0)
+		{
+			OutGrid.NodeCells.Add(CellIndex);
+		}
+	}
+	OutGrid.CompletedStageNum = (int32)EXkHexagonGenerateStage::Num;
+}
+
+
+bool FXkHexagonalWorldFile::Validate() const
+{
+	if (DataSize < (int64)sizeof(FXkHexagonalWorldFileHeader))
+	{
+		return false;
+	}
+	const FXkHexagonalWorldFileHeader& Header = GetHeader();
+	if (Header.Magic != HEXAGON_WORLD_FILE_MAGIC || Header.Version != HEXAGON_WORLD_FILE_VERSION ||
+		Header.MaxManhattanDistance < 0 || Header.Pitch != Header.MaxManhattanDistance * 2 + 1)
+	{
+		return false;
+	}
+	const uint64 CellNum = (uint64)Header.Pitch * (uint64)Header.Pitch;
+	return Header.TypeOffset + CellNum * sizeof(uint8) <= (uint64)DataSize
+		&& Header.SplatOffset + CellNum * sizeof(uint8) <= (uint64)DataSize
+		&& Header.PositionOffset + CellNum * sizeof(FVector4f) <= (uint64)DataSize
+		&& Header.CustomDataOffset + CellNum * sizeof(FVector4f) <= (uint64)DataSize;
+}
+
+
+FXkHexagonNode FXkHexagonalWorldFile::MakeNode(const int32 InCellIndex, const FIntVector& InCoord) const
+{
+	FXkHexagonNode Node = FXkHexagonNode((EXkHexagonType)GetTypes()[InCellIndex], GetPositions()[InCellIndex], GetSplats()[InCellIndex], InCoord);
+	Node.CustomData = GetCustomData()[InCellIndex];
+	return Node;
+}
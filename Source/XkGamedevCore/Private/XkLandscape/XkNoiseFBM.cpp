@@ -0,0 +1,198 @@
+// Copyright ©ICEPRINCE. All Rights Reserved.
+
+#include "XkLandscape/XkNoiseFBM.h"
+
+
+static FORCEINLINE VectorRegister4Float VectorFrac(const VectorRegister4Float& InValue)
+{
+	// HLSL frac, x - floor(x)
+	return VectorSubtract(InValue, VectorFloor(InValue));
+}
+
+
+static FORCEINLINE float VectorFirstLane(const VectorRegister4Float& InValue)
+{
+	float Values[4];
+	VectorStore(InValue, Values);
+	return Values[0];
+}
+
+
+static FORCEINLINE VectorRegister4Int VectorRandomHash(VectorRegister4Int InX, VectorRegister4Int InY)
+{
+	// RandomHash(v).x of the shader, pcg2d, the y result is not needed
+	const VectorRegister4Int Multiplier = VectorIntSet1(1664525);
+	const VectorRegister4Int Increment = VectorIntSet1(1013904223);
+	InX = VectorIntAdd(VectorIntMultiply(InX, Multiplier), Increment);
+	InY = VectorIntAdd(VectorIntMultiply(InY, Multiplier), Increment);
+	InX = VectorIntAdd(InX, VectorIntMultiply(InY, Multiplier));
+	InY = VectorIntAdd(InY, VectorIntMultiply(InX, Multiplier));
+	InX = VectorIntXor(InX, VectorShiftRightImmLogical(InX, 16));
+	InY = VectorIntXor(InY, VectorShiftRightImmLogical(InY, 16));
+	InX = VectorIntAdd(InX, VectorIntMultiply(InY, Multiplier));
+	return VectorIntXor(InX, VectorShiftRightImmLogical(InX, 16));
+}
+
+
+static FORCEINLINE VectorRegister4Float VectorRandomUnit(const VectorRegister4Int& InHash)
+{
+	// float(h >> 8) / 2^24
+	return VectorMultiply(VectorIntToFloat(VectorShiftRightImmLogical(InHash, 8)), VectorSetFloat1(1.0f / 16777216.0f));
+}
+
+
+VectorRegister4Float FXkNoiseFBM::RandomNoise2(const VectorRegister4Float& InX, const VectorRegister4Float& InY)
+{
+	// RandomUnit(RandomHash(uint2(int2(st))).x), both truncate to int
+	return VectorRandomUnit(VectorRandomHash(VectorFloatToInt(InX), VectorFloatToInt(InY)));
+}
+
+
+VectorRegister4Float FXkNoiseFBM::FbmNoise(const VectorRegister4Float& InX, const VectorRegister4Float& InY)
+{
+	const VectorRegister4Float One = VectorOne();
+	const VectorRegister4Float IX = VectorFloor(InX);
+	const VectorRegister4Float IY = VectorFloor(InY);
+	const VectorRegister4Float FX = VectorFrac(InX);
+	const VectorRegister4Float FY = VectorFrac(InY);
+
+	// Four corners in 2D of a tile
+	const VectorRegister4Float A = RandomNoise2(IX, IY);
+	const VectorRegister4Float B = RandomNoise2(VectorAdd(IX, One), IY);
+	const VectorRegister4Float C = RandomNoise2(IX, VectorAdd(IY, One));
+	const VectorRegister4Float D = RandomNoise2(VectorAdd(IX, One), VectorAdd(IY, One));
+
+	// u = f * f * (3.0 - 2.0 * f)
+	const VectorRegister4Float Three = VectorSetFloat1(3.0f);
+	const VectorRegister4Float Two = VectorSetFloat1(2.0f);
+	const VectorRegister4Float UX = VectorMultiply(VectorMultiply(FX, FX), VectorSubtract(Three, VectorMultiply(Two, FX)));
+	const VectorRegister4Float UY = VectorMultiply(VectorMultiply(FY, FY), VectorSubtract(Three, VectorMultiply(Two, FY)));
+
+	// lerp(a, b, u.x) + (c - a) * u.y * (1.0 - u.x) + (d - b) * u.x * u.y
+	const VectorRegister4Float Lerp = VectorAdd(A, VectorMultiply(UX, VectorSubtract(B, A)));
+	const VectorRegister4Float Term0 = VectorMultiply(VectorMultiply(VectorSubtract(C, A), UY), VectorSubtract(One, UX));
+	const VectorRegister4Float Term1 = VectorMultiply(VectorMultiply(VectorSubtract(D, B), UX), UY);
+	return VectorAdd(VectorAdd(Lerp, Term0), Term1);
+}
+
+
+VectorRegister4Float FXkNoiseFBM::FBMSimulate(VectorRegister4Float InX, VectorRegister4Float InY)
+{
+	const VectorRegister4Float Two = VectorSetFloat1(2.0f);
+	VectorRegister4Float Value = VectorZero();
+	float Amplitude = 0.5f;
+	for (int32 Octave = 0; Octave < Octaves; Octave++)
+	{
+		Value = VectorAdd(Value, VectorMultiply(VectorSetFloat1(Amplitude), FbmNoise(InX, InY)));
+		InX = VectorMultiply(InX, Two);
+		InY = VectorMultiply(InY, Two);
+		Amplitude *= 0.5f;
+	}
+	return Value;
+}
+
+
+float FXkNoiseFBM::RandomNoise1(const FVector2f& InST)
+{
+	// RandomUnit(RandomHash(asuint(st)).x)
+	const VectorRegister4Int X = VectorCastFloatToInt(VectorSetFloat1(InST.X));
+	const VectorRegister4Int Y = VectorCastFloatToInt(VectorSetFloat1(InST.Y));
+	return VectorFirstLane(VectorRandomUnit(VectorRandomHash(X, Y)));
+}
+
+
+float FXkNoiseFBM::RandomNoise2(const FVector2f& InST)
+{
+	return VectorFirstLane(RandomNoise2(VectorSetFloat1(InST.X), VectorSetFloat1(InST.Y)));
+}
+
+
+float FXkNoiseFBM::FbmNoise(const FVector2f& InST)
+{
+	return VectorFirstLane(FbmNoise(VectorSetFloat1(InST.X), VectorSetFloat1(InST.Y)));
+}
+
+
+float FXkNoiseFBM::FBMSimulate(const FVector2f& InST)
+{
+	return VectorFirstLane(FBMSimulate(VectorSetFloat1(InST.X), VectorSetFloat1(InST.Y)));
+}
+
+
+float FXkNoiseFBM::OutputFBM(const FVector2f& InST)
+{
+	return FBMSimulate(InST * 3.0f);
+}
+
+
+float FXkNoiseFBM::OutputFBM(const FVector3f& InWorldPosition, const float InSize)
+{
+	const FVector3f UV = InWorldPosition / InSize;
+	return OutputFBM(FVector2f(UV.X, UV.Y));
+}
+
+
+float FXkNoiseFBM::OutputFBM(const FVector3f& InWorldPosition, const FVector3f& InRandom, const float InSize, const float InLevel)
+{
+	float Output;
+	OutputFBMBatch(&InWorldPosition, InRandom, InSize, InLevel, &Output, 1);
+	return Output;
+}
+
+
+void FXkNoiseFBM::FBMSimulateBatch(const FVector2f* InST, float* OutValues, const int32 InNum)
+{
+	int32 Index = 0;
+	for (; Index + 8 <= InNum; Index += 8)
+	{
+		const FVector2f* ST = InST + Index;
+		const VectorRegister4Float Value0 = FBMSimulate(
+			MakeVectorRegisterFloat(ST[0].X, ST[1].X, ST[2].X, ST[3].X), MakeVectorRegisterFloat(ST[0].Y, ST[1].Y, ST[2].Y, ST[3].Y));
+		const VectorRegister4Float Value1 = FBMSimulate(
+			MakeVectorRegisterFloat(ST[4].X, ST[5].X, ST[6].X, ST[7].X), MakeVectorRegisterFloat(ST[4].Y, ST[5].Y, ST[6].Y, ST[7].Y));
+		VectorStore(Value0, OutValues + Index);
+		VectorStore(Value1, OutValues + Index + 4);
+	}
+	for (; Index < InNum; Index++)
+	{
+		OutValues[Index] = FBMSimulate(InST[Index]);
+	}
+}
+
+
+void FXkNoiseFBM::OutputFBMBatch(const FVector3f* InWorldPositions, const FVector3f& InRandom, const float InSize, const float InLevel, float* OutValues, const int32 InNum)
+{
+	// pos_to_uv = (world_pos + random) - to_center, uv = floor(pos_to_uv / size)
+	const float ToCenter = 500.0f;
+	const VectorRegister4Float Size = VectorSetFloat1(InSize);
+	const VectorRegister4Float Level = VectorSetFloat1(InLevel);
+	const VectorRegister4Float Three = VectorSetFloat1(3.0f);
+	const VectorRegister4Float Half = VectorSetFloat1(0.5f);
+	const VectorRegister4Float Zero = VectorZero();
+	const VectorRegister4Float One = VectorOne();
+
+	for (int32 Index = 0; Index < InNum; Index += 4)
+	{
+		float X[4], Y[4];
+		for (int32 Lane = 0; Lane < 4; Lane++)
+		{
+			// Tail lanes repeat the last sample and are not stored.
+			const FVector3f& WorldPosition = InWorldPositions[FMath::Min(Index + Lane, InNum - 1)];
+			X[Lane] = (WorldPosition.X + InRandom.X) - ToCenter;
+			Y[Lane] = (WorldPosition.Y + InRandom.Y) - ToCenter;
+		}
+		const VectorRegister4Float U = VectorMultiply(VectorFloor(VectorDivide(VectorLoad(X), Size)), Three);
+		const VectorRegister4Float V = VectorMultiply(VectorFloor(VectorDivide(VectorLoad(Y), Size)), Three);
+		// saturate(RemapValue(fbm, 0, level, 0, 1)), then round, half to even like the GPU round
+		VectorRegister4Float Output = VectorDivide(FBMSimulate(U, V), Level);
+		Output = VectorMin(VectorMax(Output, Zero), One);
+		Output = VectorSelect(VectorCompareGT(Output, Half), One, Zero);
+
+		float Values[4];
+		VectorStore(Output, Values);
+		for (int32 Lane = 0; Lane < 4 && Index + Lane < InNum; Lane++)
+		{
+			OutValues[Index + Lane] = Values[Lane];
+		}
+	}
+}
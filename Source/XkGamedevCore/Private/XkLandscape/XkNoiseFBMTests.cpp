@@ -0,0 +1,71 @@
+// Copyright ©ICEPRINCE. All Rights Reserved.
+
+#include "XkLandscape/XkNoiseFBM.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FXkNoiseFBMParityTest, "XkGamedev.Landscape.NoiseFBM.Parity",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FXkNoiseFBMParityTest::RunTest(const FString& Parameters)
+{
+	// Reference values of XkNoiseFBM.ush. The hash is integer math, and at integer coords the
+	// fraction is zero, so every GPU gives these bits exactly. Other coords go through the smoothstep,
+	// where the shader compiler may fuse mul and add, so those only match within the tolerance.
+	struct FIntegerSample { FVector2f ST; uint32 HashBits; float FBM; };
+	const FIntegerSample IntegerSamples[] = {
+		{ FVector2f(0.0f, 0.0f), 1631281u, 0.0957126766f },
+		{ FVector2f(1.0f, 0.0f), 10341361u, 0.364641637f },
+		{ FVector2f(0.0f, 1.0f), 9035872u, 0.610929966f },
+		{ FVector2f(-3.0f, 7.0f), 16213488u, 0.579298556f },
+		{ FVector2f(123.0f, -456.0f), 14059510u, 0.630663753f },
+		{ FVector2f(1000.0f, 2000.0f), 7469177u, 0.507280231f },
+	};
+	struct FFractionSample { FVector2f ST; float FBM; };
+	const FFractionSample FractionSamples[] = {
+		{ FVector2f(0.25f, 0.75f), 0.481875062f },
+		{ FVector2f(-12.5f, 3.125f), 0.698349416f },
+		{ FVector2f(57.3f, -8.9f), 0.610548079f },
+	};
+	const float Tolerance = 1e-5f;
+
+	TArray<FVector2f> BatchST;
+	for (const FIntegerSample& Sample : IntegerSamples)
+	{
+		TestEqual(FString::Printf(TEXT("RandomNoise2 %s"), *Sample.ST.ToString()), FXkNoiseFBM::RandomNoise2(Sample.ST), (float)Sample.HashBits / 16777216.0f, 0.0f);
+		TestEqual(FString::Printf(TEXT("FBMSimulate %s"), *Sample.ST.ToString()), FXkNoiseFBM::FBMSimulate(Sample.ST), Sample.FBM, 0.0f);
+		BatchST.Add(Sample.ST);
+	}
+	for (const FFractionSample& Sample : FractionSamples)
+	{
+		TestEqual(FString::Printf(TEXT("FBMSimulate %s"), *Sample.ST.ToString()), FXkNoiseFBM::FBMSimulate(Sample.ST), Sample.FBM, Tolerance);
+		BatchST.Add(Sample.ST);
+	}
+
+	// Nine samples run one register pair and the scalar tail, both must give the scalar bits.
+	TArray<float> BatchValues;
+	BatchValues.SetNumZeroed(BatchST.Num());
+	FXkNoiseFBM::FBMSimulateBatch(BatchST.GetData(), BatchValues.GetData(), BatchST.Num());
+	for (int32 Index = 0; Index < BatchST.Num(); Index++)
+	{
+		TestEqual(FString::Printf(TEXT("FBMSimulateBatch %s"), *BatchST[Index].ToString()), BatchValues[Index], FXkNoiseFBM::FBMSimulate(BatchST[Index]), 0.0f);
+	}
+
+	TArray<FVector3f> WorldPositions;
+	for (const FVector2f& ST : BatchST)
+	{
+		WorldPositions.Add(FVector3f(ST.X * 1000.0f, ST.Y * 1000.0f, 0.0f));
+	}
+	const FVector3f Random(17.0f, -31.0f, 0.0f);
+	TArray<float> MaskValues;
+	MaskValues.SetNumZeroed(WorldPositions.Num());
+	FXkNoiseFBM::OutputFBMBatch(WorldPositions.GetData(), Random, 500.0f, 0.6f, MaskValues.GetData(), WorldPositions.Num());
+	for (int32 Index = 0; Index < WorldPositions.Num(); Index++)
+	{
+		TestEqual(FString::Printf(TEXT("OutputFBMBatch %s"), *WorldPositions[Index].ToString()), MaskValues[Index], FXkNoiseFBM::OutputFBM(WorldPositions[Index], Random, 500.0f, 0.6f), 0.0f);
+	}
+	return true;
+}
+
+#endif
@@ -93,12 +93,17 @@ bool UXkCanvasRendererComponent::IsBuffersValid() const
 }
 
 
-void UXkCanvasRendererComponent::CreateBuffers(const TArray<FVector4f> Vertices, const TArray<uint32> Indices, const TArray<FVector4f> Positions, const TArray<FVector4f> Weights)
+void UXkCanvasRendererComponent::CreateBuffers(const TArray<FVector4f>& Vertices, const TArray<uint32>& Indices, const TArray<FVector4f>& Positions, const TArray<FVector4f>& Weights)
 {
-	VertexBuffer.Positions = Vertices;
-	TArray<FVector2f> UVs; UVs.Init(FVector2f(), Vertices.Num());
-	VertexBuffer.UVs = UVs;
-	IndexBuffer.Indices = Indices;
+	// Every redraw passes the same shared hexagon, only the instances are new.
+	const bool bMeshChanged = !VertexBuffer.VertexBufferRHI.IsValid() || !IndexBuffer.IndexBufferRHI.IsValid()
+		|| VertexBuffer.Positions != Vertices || IndexBuffer.Indices != Indices;
+	if (bMeshChanged)
+	{
+		VertexBuffer.Positions = Vertices;
+		VertexBuffer.UVs.Init(FVector2f(), Vertices.Num());
+		IndexBuffer.Indices = Indices;
+	}
 
 	InstancePositionBuffer.Data = Positions;
 	InstanceWeightBuffer.Data = Weights;
@@ -107,8 +112,11 @@ void UXkCanvasRendererComponent::CreateBuffers(const TArray<FVector4f> Vertices,
 	(FRHICommandListImmediate& RHICmdList)
 		{
 			TRACE_CPUPROFILER_EVENT_SCOPE(UXkCanvasRendererComponent_CreateBuffers);
-			VertexBuffer.InitRHI();
-			IndexBuffer.InitRHI();
+			if (bMeshChanged)
+			{
+				VertexBuffer.InitRHI();
+				IndexBuffer.InitRHI();
+			}
 			InstancePositionBuffer.InitRHI();
 			InstanceWeightBuffer.InitRHI();
 		});
@@ -156,6 +164,57 @@ void UXkCanvasRendererComponent::UpdateBuffers(const TArray<FVector4f> Positions
 
 
 void UXkCanvasRendererComponent::DrawCanvas()
+{
+	DrawCanvasRect(FIntRect());
+}
+
+
+void UXkCanvasRendererComponent::DrawCanvas(const FBox2D& InDirtyBounds)
+{
+	const FIntRect DirtyRect = GetCanvasDirtyRect(InDirtyBounds);
+	if (DirtyRect.Area() > 0)
+	{
+		DrawCanvasRect(DirtyRect);
+	}
+}
+
+
+FIntRect UXkCanvasRendererComponent::GetCanvasDirtyRect(const FBox2D& InDirtyBounds) const
+{
+	if (!InDirtyBounds.bIsValid || CanvasExtent.X <= 0.0f || CanvasExtent.Y <= 0.0f)
+	{
+		return FIntRect();
+	}
+	// Same mapping as XkRendererVS, canvas center at the texture center and the extent covering the texture.
+	const FVector2D CanvasSize = GetCanvasSize();
+	const FVector2D Center = FVector2D(CanvasCenter.X, CanvasCenter.Y);
+	const FVector2D Extent = FVector2D(CanvasExtent.X, CanvasExtent.Y);
+	const FVector2D Min = ((InDirtyBounds.Min - Center) / Extent + 0.5) * CanvasSize;
+	const FVector2D Max = ((InDirtyBounds.Max - Center) / Extent + 0.5) * CanvasSize;
+	// Height, normal and SDF filters read neighbors, pixels that far from the bounds change as well.
+	const int32 SdfMaxRange = 64;
+	const int32 Margin = GetHeightFilterRange() + ConvolutionRangeY + SdfMaxRange;
+	FIntRect DirtyRect = FIntRect(
+		FMath::FloorToInt(Min.X) - Margin, FMath::FloorToInt(Min.Y) - Margin,
+		FMath::CeilToInt(Max.X) + Margin, FMath::CeilToInt(Max.Y) + Margin);
+	DirtyRect.Clip(FIntRect(0, 0, (int32)CanvasSize.X, (int32)CanvasSize.Y));
+	return DirtyRect;
+}
+
+
+FBox2D UXkCanvasRendererComponent::GetCanvasRectBounds(const FIntRect& InRect) const
+{
+	// Inverse of the GetCanvasDirtyRect mapping.
+	const FVector2D CanvasSize = GetCanvasSize();
+	const FVector2D Center = FVector2D(CanvasCenter.X, CanvasCenter.Y);
+	const FVector2D Extent = FVector2D(CanvasExtent.X, CanvasExtent.Y);
+	const FVector2D Min = (FVector2D(InRect.Min) / CanvasSize - 0.5) * Extent + Center;
+	const FVector2D Max = (FVector2D(InRect.Max) / CanvasSize - 0.5) * Extent + Center;
+	return FBox2D(Min, Max);
+}
+
+
+void UXkCanvasRendererComponent::DrawCanvasRect(const FIntRect& InDirtyRect)
 {
 	if (!CanvasRT0 || !CanvasRT1 || InstancePositionBuffer.GetInstanceNum() == 0 || InstanceWeightBuffer.GetInstanceNum() == 0)
 	{
@@ -165,7 +224,8 @@ void UXkCanvasRendererComponent::DrawCanvas()
 	UTextureRenderTarget2D* Canvas0 = CanvasRT0;
 	UTextureRenderTarget2D* Canvas1 = CanvasRT1;
 	FIntVector4 TextureFilter = FIntVector4(ConvolutionRangeX, ConvolutionRangeY, ConvolutionRangeZ, 0);
-	FIntVector4 SuperResMask = FIntVector4(SplatMaskRange.X, SplatMaskRange.Y, 2, 4);
+	FIntVector4 SuperResMask = FIntVector4(SplatMaskRange.X, SplatMaskRange.Y, HeightSuperResRange, HeightSuperResScale);
+	const int32 HeightFilterRange = GetHeightFilterRange();
 	FVector4f Center = CanvasCenter;
 	FVector4f Extent = CanvasExtent;
 	FXkCanvasVertexBuffer* VertexBuf = &VertexBuffer;
@@ -175,18 +235,15 @@ void UXkCanvasRendererComponent::DrawCanvas()
 	FXkCanvasRenderVS::FParameters VertexShaderParamsToCopy;
 	FXkCanvasRenderPS::FParameters PixelShaderParamsToCopy;
 	FMatrix44f LocalToWorld = FMatrix44f(GetOwner()->GetTransform().ToMatrixWithScale());
+	FIntRect DirtyRect = InDirtyRect;
 	RenderCaptureInterface::FScopedCapture RenderCapture(CaptureDrawCanvas, TEXT("CaptureDrawCanvas"));
-	ENQUEUE_RENDER_COMMAND(UXkRendererComponent_DrawCanvas)([Canvas0, Canvas1, TextureFilter, SuperResMask, LocalToWorld, Center, Extent,
+	ENQUEUE_RENDER_COMMAND(UXkRendererComponent_DrawCanvas)([Canvas0, Canvas1, TextureFilter, SuperResMask, LocalToWorld, Center, Extent, DirtyRect, HeightFilterRange,
 		VertexShaderParamsToCopy, PixelShaderParamsToCopy, VertexBuf, IndexBuf, InstancePositionBuf, InstanceWeightBuf]
 		(FRHICommandListImmediate& RHICmdList)
 		{
 			TRACE_CPUPROFILER_EVENT_SCOPE(UXkCanvasRendererComponent_DrawCanvas);
 
-			VertexBuf->InitRHI();
-			IndexBuf->InitRHI();
-			InstancePositionBuf->InitRHI();
-			InstanceWeightBuf->InitRHI();
-
+			// The buffers were created by CreateBuffers, drawing never uploads them again.
 			FRDGBuilder GraphBuilder(RHICmdList, RDG_EVENT_NAME("CaptureDrawCanvas"));
 
 			uint32 NumInstances = InstancePositionBuf->Data.Num();
@@ -202,9 +259,27 @@ void UXkCanvasRendererComponent::DrawCanvas()
 			FRDGTextureRef Canvas1_RDG = GraphBuilder.RegisterExternalTexture(Canvas1_RT);
 
 			FIntVector TextureSize = Canvas0_RDG->Desc.GetSize();
-			FRHICopyTextureInfo CopyTextureInfo;
-			CopyTextureInfo.NumMips = 1;
-			CopyTextureInfo.Size = TextureSize;
+			const bool bFullCanvas = DirtyRect.Area() <= 0;
+			const FIntRect DrawRect = bFullCanvas ? FIntRect(0, 0, TextureSize.X, TextureSize.Y) : DirtyRect;
+			auto MakeCopyTextureInfo = [](const FIntRect& InRect)
+				{
+					FRHICopyTextureInfo CopyInfo;
+					CopyInfo.NumMips = 1;
+					CopyInfo.Size = FIntVector(InRect.Width(), InRect.Height(), 1);
+					CopyInfo.SourcePosition = FIntVector(InRect.Min.X, InRect.Min.Y, 0);
+					CopyInfo.DestPosition = CopyInfo.SourcePosition;
+					return CopyInfo;
+				};
+			const FRHICopyTextureInfo CopyTextureInfo = MakeCopyTextureInfo(DrawRect);
+			// The height filter of the rect reads unfiltered heights up to its range around it, the instances are drawn
+			// there as well. The filtered pixels of that ring are kept aside and put back once the heights are filtered.
+			FIntRect RasterRect = DrawRect;
+			if (!bFullCanvas)
+			{
+				RasterRect.InflateRect(HeightFilterRange);
+				RasterRect.Clip(FIntRect(0, 0, TextureSize.X, TextureSize.Y));
+			}
+			const FRHICopyTextureInfo RasterCopyTextureInfo = MakeCopyTextureInfo(RasterRect);
 
 			const ETextureCreateFlags TextureFlags = TexCreate_ShaderResource | TexCreate_UAV | TexCreate_GenerateMipCapable | TexCreate_RenderTargetable;
 			const FRDGTextureDesc Desc = FRDGTextureDesc::Create2D(FIntPoint(TextureSize.X, TextureSize.Y),
@@ -235,25 +310,41 @@ void UXkCanvasRendererComponent::DrawCanvas()
 			VertexShaderParams->InstanceWeightBuffer = InstanceWeightBuf->ShaderResourceViewRHI.GetReference();
 			PixelShaderParams->Parameters = PassUniformBuffer;
 
-			PixelShaderParams->RenderTargets[0] = FRenderTargetBinding(Canvas0_RDG, ERenderTargetLoadAction::EClear, /*InMipIndex = */0);
-			PixelShaderParams->RenderTargets[1] = FRenderTargetBinding(Canvas1_RDG, ERenderTargetLoadAction::EClear, /*InMipIndex = */0);
+			// A dirty rect keeps the rest of the canvas, so only the rect is cleared.
+			ERenderTargetLoadAction LoadAction = ERenderTargetLoadAction::EClear;
+			FRDGTextureRef CanvasRing_RDG = nullptr;
+			if (!bFullCanvas)
+			{
+				CanvasRing_RDG = GraphBuilder.CreateTexture(Desc, TEXT("CanvasRing"));
+				AddCopyTexturePass(GraphBuilder, Canvas0_RDG, CanvasRing_RDG, RasterCopyTextureInfo);
+				AddClearRenderTargetPass(GraphBuilder, Canvas0_RDG, Canvas0_RDG->Desc.ClearValue.GetClearColor(), RasterRect);
+				AddClearRenderTargetPass(GraphBuilder, Canvas1_RDG, Canvas1_RDG->Desc.ClearValue.GetClearColor(), RasterRect);
+				LoadAction = ERenderTargetLoadAction::ELoad;
+			}
+			PixelShaderParams->RenderTargets[0] = FRenderTargetBinding(Canvas0_RDG, LoadAction, /*InMipIndex = */0);
+			PixelShaderParams->RenderTargets[1] = FRenderTargetBinding(Canvas1_RDG, LoadAction, /*InMipIndex = */0);
 			FIntRect Viewport = FIntRect(0, 0, TextureSize.X, TextureSize.Y);
 			XkCanvasRendererDraw(GraphBuilder, NumInstances, Viewport, VertexShaderParams, PixelShaderParams,
-				VertexBuf, IndexBuf);
+				VertexBuf, IndexBuf, bFullCanvas ? FIntRect() : RasterRect);
 			FXkCanvasRenderCS::FParameters* ComputerShaderParams =
 				GraphBuilder.AllocParameters<FXkCanvasRenderCS::FParameters>();
 			ComputerShaderParams->TextureFilter = FIntVector4(TextureFilter.X, TextureFilter.Y, TextureFilter.Z, TextureSize.X);
 			ComputerShaderParams->SuperResMask = SuperResMask;
-			ComputerShaderParams->Center = Center; // @TODO: just computer the pixel area which changed by game logic
+			ComputerShaderParams->Center = Center;
 			ComputerShaderParams->Extent = Extent;
+			ComputerShaderParams->DispatchOffset = DrawRect.Min;
 			ComputerShaderParams->SourceTexture0 = Canvas0_RDG;
 			ComputerShaderParams->SourceTexture1 = Canvas1_RDG;
 			ComputerShaderParams->TargetTexture = GraphBuilder.CreateUAV(CanvasTemp_RDG);
 			FIntVector GroupCount = FIntVector(
-				FMath::CeilToInt((float)TextureSize.X / FXkCanvasRenderCS::ThreadGroupSizeX),
-				FMath::CeilToInt((float)TextureSize.Y / FXkCanvasRenderCS::ThreadGroupSizeY),
+				FMath::CeilToInt((float)DrawRect.Width() / FXkCanvasRenderCS::ThreadGroupSizeX),
+				FMath::CeilToInt((float)DrawRect.Height() / FXkCanvasRenderCS::ThreadGroupSizeY),
 				1);
 			XkCanvasComputeDispatch<FXkCanvasRenderHeightCS>(GraphBuilder, ComputerShaderParams, GroupCount);
+			if (CanvasRing_RDG)
+			{
+				AddCopyTexturePass(GraphBuilder, CanvasRing_RDG, Canvas0_RDG, RasterCopyTextureInfo);
+			}
 			AddCopyTexturePass(GraphBuilder, CanvasTemp_RDG, Canvas0_RDG, CopyTextureInfo);
 			XkCanvasComputeDispatch<FXkCanvasRenderNormalCS>(GraphBuilder, ComputerShaderParams, GroupCount);
 			AddCopyTexturePass(GraphBuilder, CanvasTemp_RDG, Canvas0_RDG, CopyTextureInfo);
@@ -131,7 +131,8 @@ void XkCanvasRendererDraw(FRDGBuilder& GraphBuilder,
 	FXkCanvasRenderVS::FParameters* InVSParameters,
 	FXkCanvasRenderPS::FParameters* InPSParameters,
 	FXkCanvasVertexBuffer* InVertexBuffer,
-	FXkCanvasIndexBuffer* InIndexBuffer)
+	FXkCanvasIndexBuffer* InIndexBuffer,
+	const FIntRect& InScissorRect)
 {
 	FGlobalShaderMap* ShaderMap = GetGlobalShaderMap(GMaxRHIFeatureLevel);
 	TShaderMapRef<FXkCanvasRenderVS> VertexShader(ShaderMap);
@@ -139,6 +140,7 @@ void XkCanvasRendererDraw(FRDGBuilder& GraphBuilder,
 
 	FRDGEventName&& PassName = RDG_EVENT_NAME("XkCanvasRendererDraw");
 	const FIntRect& Viewport = InDestinationBounds;
+	const FIntRect ScissorRect = InScissorRect;
 	FRHIBlendState* BlendState = nullptr;
 	FRHIRasterizerState* RasterizerState = nullptr;
 	FRHIDepthStencilState* DepthStencilState = nullptr;
@@ -151,11 +153,16 @@ void XkCanvasRendererDraw(FRDGBuilder& GraphBuilder,
 		Forward<FRDGEventName>(PassName),
 		InPSParameters,
 		ERDGPassFlags::Raster,
-		[InNumInstances, InVSParameters, InPSParameters, InVertexBuffer, InIndexBuffer, VertexShader, PixelShader, Viewport, BlendState, RasterizerState, DepthStencilState, StencilRef]
+		[InNumInstances, InVSParameters, InPSParameters, InVertexBuffer, InIndexBuffer, VertexShader, PixelShader, Viewport, ScissorRect, BlendState, RasterizerState, DepthStencilState, StencilRef]
 	(FRHICommandList& RHICmdList)
 		{
 			check(VertexShader.IsValid() && PixelShader.IsValid());
 			RHICmdList.SetViewport((float)Viewport.Min.X, (float)Viewport.Min.Y, 0.0f, (float)Viewport.Max.X, (float)Viewport.Max.Y, 1.0f);
+			// Only the dirty rect is rasterized again, the rest of the canvas is loaded.
+			if (ScissorRect.Area() > 0)
+			{
+				RHICmdList.SetScissorRect(true, ScissorRect.Min.X, ScissorRect.Min.Y, ScissorRect.Max.X, ScissorRect.Max.Y);
+			}
 
 			FGraphicsPipelineStateInitializer GraphicsPSOInit;
 			// @see: 
@@ -9,6 +9,12 @@
 #include "XkHexagon/XkHexagonActors.h"
 #include "XkHexagon/XkHexagonComponents.h"
 #include "XkHexagon/XkHexagonPathfinding.h"
+#include "XkHexagon/XkHexagonWorldFile.h"
+#include "XkHexagon/XkHexagonChunks.h"
+#include "XkHexagon/XkHexagonRandom.h"
+#include "XkHexagon/XkHexagonGenerator.h"
+#include "XkHexagon/XkHexagonGenerateJob.h"
+#include "XkHexagon/XkHexagonGenerateCache.h"
 #include "XkLandscape/XkLandscapeRenderUtils.h"
 #include "XkRenderer/XkRendererRenderUtils.h"
 #include "XkGameWorld.generated.h"
@@ -34,9 +40,17 @@ public:
 	UPROPERTY(EditAnywhere, Category = "MainWorldGenerate [KEVINTSUIXUGAMEDEV]")
 	FVector2D PositionRandomRange;
 
+	/* Seed of every random decision made while generating, same seed same world. */
+	UPROPERTY(EditAnywhere, Category = "MainWorldGenerate [KEVINTSUIXUGAMEDEV]")
+	int32 WorldSeed;
+
 	UPROPERTY(EditAnywhere, Category = "MainWorldGenerate [KEVINTSUIXUGAMEDEV]")
 	TArray<FXkHexagonSplat> HexagonSplats;
 
+	/* World size of one cell of the FBM terrain noise scaled by the NoiseHeight of the splats, no noise when zero. */
+	UPROPERTY(EditAnywhere, Category = "MainWorldGenerate [KEVINTSUIXUGAMEDEV]", meta = (ClampMin = "0"))
+	float HeightNoiseSize;
+
 	/* The splat id in the range of HexagonSplatMaskRange would do discard in VS. */
 	UPROPERTY(EditAnywhere, Category = "MainWorldGenerate [KEVINTSUIXUGAMEDEV]")
 	FVector2D HexagonSplatMaskRange;
@@ -56,11 +70,41 @@ public:
 	UPROPERTY(EditAnywhere, Category = "MainWorldGenerate [KEVINTSUIXUGAMEDEV]")
 	bool bShowSpawnedActorEdgeMesh;
 
+	/* Cooked world file relative to Content/XkHexagonalWorlds, RegenerateWorld maps it instead of generating when it exists.
+	 * Packaged builds need the directory in DirectoriesToAlwaysStageAsNonUFS, see HEXAGON_WORLD_FILE_DIRECTORY. */
+	UPROPERTY(EditAnywhere, Category = "MainWorldGenerate [KEVINTSUIXUGAMEDEV]")
+	FString CookedWorldFile;
+
+	/* Keep generated worlds in Saved/XkHexagonalWorldCache by the hash of the generate properties, generating settings used before only maps the file. */
+	UPROPERTY(EditAnywhere, Category = "MainWorldGenerate [KEVINTSUIXUGAMEDEV]")
+	bool bUseGenerateCache;
+
+	/* Stream the world in chunks around the top down camera instead of holding the whole node table. */
+	UPROPERTY(EditAnywhere, Category = "WorldStreaming [KEVINTSUIXUGAMEDEV]")
+	bool bStreamChunks;
+
+	/* Chunk distance around the camera chunk to load, a chunk is HEXAGON_CHUNK_SIZE coords wide. */
+	UPROPERTY(EditAnywhere, Category = "WorldStreaming [KEVINTSUIXUGAMEDEV]", meta = (EditCondition = "bStreamChunks", ClampMin = "0"))
+	int32 ChunkLoadRadius;
+
+	/* Chunk distance beyond which chunks are unloaded, greater than ChunkLoadRadius to avoid thrashing. */
+	UPROPERTY(EditAnywhere, Category = "WorldStreaming [KEVINTSUIXUGAMEDEV]", meta = (EditCondition = "bStreamChunks", ClampMin = "0"))
+	int32 ChunkUnloadRadius;
+
+	UPROPERTY(EditAnywhere, Category = "WorldStreaming [KEVINTSUIXUGAMEDEV]", meta = (EditCondition = "bStreamChunks", ClampMin = "1"))
+	int32 MaxAppliedChunksPerFrame;
+
 	AXkSphericalWorldWithOceanActor(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
 
 	//~ Begin Actor Interface
+	void BeginPlay() override;
 	void TickActor(float DeltaTime, enum ELevelTick TickType, FActorTickFunction& ThisTickFunction) override;
 	void OnConstruction(const FTransform& Transform) override;
+	void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	bool ShouldTickIfViewportsOnly() const override;
+#if WITH_EDITOR
+	void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
 	//~ End Actor Interface
 
 	UFUNCTION(BlueprintCallable, Category = "MainWorldGenerate [KEVINTSUIXUGAMEDEV]")
@@ -75,6 +119,137 @@ public:
 	UFUNCTION(CallInEditor, BlueprintCallable, Category = "MainWorldGenerate [KEVINTSUIXUGAMEDEV]")
 	void RegenerateWorld();
 
+	/**
+	* @brief Generate the world on worker threads, the current world stays until the new one is swapped in by TickActor
+	*/
+	UFUNCTION(CallInEditor, BlueprintCallable, Category = "MainWorldGenerate [KEVINTSUIXUGAMEDEV]")
+	void RegenerateWorldAsync();
+
+	/**
+	* @brief Bring the generated world up to the current properties, only the stages and rings whose inputs changed
+	* are generated again and only their part of the canvas is drawn. Falls back to RegenerateWorldAsync.
+	*/
+	UFUNCTION(CallInEditor, BlueprintCallable, Category = "MainWorldGenerate [KEVINTSUIXUGAMEDEV]")
+	void UpdateWorld();
+
+	/* Whether UpdateWorld could reuse the generated world.*/
+	bool CanUpdateWorld() const;
+
+	UFUNCTION(BlueprintCallable, Category = "MainWorldGenerate [KEVINTSUIXUGAMEDEV]")
+	bool IsRegeneratingWorld() const { return RegenerateJob.IsRunning(); };
+
+	/* Progress of RegenerateWorldAsync in [0, 1], 1 when not regenerating.*/
+	UFUNCTION(BlueprintCallable, Category = "MainWorldGenerate [KEVINTSUIXUGAMEDEV]")
+	float GetRegenerateWorldProgress() const { return RegenerateJob.GetProgress(); };
+
+	UFUNCTION(BlueprintCallable, Category = "MainWorldGenerate [KEVINTSUIXUGAMEDEV]")
+	void CancelRegenerateWorld() { RegenerateJob.Cancel(); };
+
+	/**
+	* @brief Save the current node table into CookedWorldFile
+	*/
+	UFUNCTION(CallInEditor, BlueprintCallable, Category = "MainWorldGenerate [KEVINTSUIXUGAMEDEV]")
+	void SaveCookedWorld();
+
+	/**
+	* @brief Memory map CookedWorldFile and fill the node table from it
+	* @return False when there is no valid cooked world, the world should be generated instead
+	*/
+	UFUNCTION(BlueprintCallable, Category = "MainWorldGenerate [KEVINTSUIXUGAMEDEV]")
+	virtual bool LoadCookedWorld();
+
+	FString GetCookedWorldFilename() const;
+
+	/* The mapped cooked world, valid after LoadCookedWorld succeeded.*/
+	const FXkHexagonalWorldFile* GetCookedWorld() const { return CookedWorld.IsValid() && CookedWorld->IsOpen() ? CookedWorld.Get() : nullptr; };
+
+	/**
+	* @brief Empty the node table and stream chunks from the cooked world, or generate them when there is none
+	*/
+	virtual void StartChunkStreaming();
+
+	/**
+	* @return Location chunks are streamed around, the top down camera when the player controls one
+	*/
+	virtual FVector GetStreamingCenter() const;
+
+	FXkHexagonalWorldGenerateSettings MakeGenerateSettings() const;
+
+	/**
+	* @return Generate cache key of every property the generated world depends on
+	*/
+	FString GetGenerateCacheKey() const;
+
+	/* Per stage timings of the last GenerateHexagons and GenerateHexagonalWorld.*/
+	const FXkHexagonGenerateStats& GetLastGenerateStats() const { return LastGenerateStats; };
+
+	const FXkHexagonalWorldChunkStreamer& GetChunkStreamer() const { return ChunkStreamer; };
+
+protected:
+	bool OpenCookedWorld();
+
+	/**
+	* @brief Swap a finished regeneration into the node table, actors and canvas in one frame
+	* @return False when there was no finished regeneration
+	*/
+	bool ApplyRegenerateResult();
+
+	/**
+	* @brief Restore the world of the current properties from the generate cache
+	* @return False on a cache miss
+	*/
+	bool LoadGenerateCache();
+
+	/* Write the generated grid into the generate cache on a worker thread.*/
+	void SaveGenerateCache();
+
+	void SpawnHexagonActors();
+
+#if WITH_EDITOR
+	/* Refresh the hexagon actors once for every construction since the last tick.*/
+	void FlushHexagonActorsRefresh();
+#endif
+
+	/* Place the pooled actor of the coord, see UXkHexagonActorPoolSubsystem.*/
+	AXkHexagonActor* SpawnHexagonActor(const FIntVector& HexagonCoord, const FVector4f& Position);
+
+	/* Give every hexagon actor of this world back to the pool.*/
+	void ReleaseHexagonActors();
+
+	/* Number of hexagon actors spawned for a whole world, the coords closer than SpawnActorsMaxMhtDist.*/
+	int32 GetSpawnActorNum() const;
+
+	/* Place, refresh or release the actors of changed coords.*/
+	void RefreshHexagonActors(const TArray<FIntVector>& InChangedCoords);
+
+	/**
+	* @param InDirtyBounds Only this part of the canvas is drawn again when the canvas extent is unchanged
+	*/
+	void DrawCanvasInstances(const TArray<FVector4f>& InstancePositionData, const TArray<FVector4f>& InstanceWeightData, const FBox2D* InDirtyBounds = nullptr);
+
+	/* Draw again the canvas area of streamed chunks, uploading only the hexagons drawn there.*/
+	void DrawChunkCanvas(const TArray<FIntPoint>& InChunkKeys);
+
+	/* Canvas extent covering the whole hexagonal world.*/
+	FVector2D GetCanvasWorldSize() const;
+
+	/* Canvas area covered by the hexagons of streaming chunks.*/
+	FBox2D GetChunkCanvasBounds(const TArray<FIntPoint>& InChunkKeys) const;
+
+private:
+	TSharedPtr<FXkHexagonalWorldFile, ESPMode::ThreadSafe> CookedWorld;
+
+	FXkHexagonalWorldChunkStreamer ChunkStreamer;
+
+	FXkHexagonalWorldGrid HexagonalWorldGrid;
+	FXkHexagonGenerateStats LastGenerateStats;
+
+	FXkHexagonalWorldGenerateJob RegenerateJob;
+
+#if WITH_EDITOR
+	bool bHexagonActorsRefreshPending;
+#endif
+
 public:
 	static float CalcSphericalHeight(const FVector& CameraLocation, const FVector& WorldLocation)
 	{
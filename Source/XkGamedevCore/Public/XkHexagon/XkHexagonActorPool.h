@@ -0,0 +1,93 @@
+// Copyright ©ICEPRINCE. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "XkHexagonActorPool.generated.h"
+
+class AXkHexagonActor;
+class AXkHexagonalWorldActor;
+
+/**
+ * Hexagon Actor Pool
+ * Hands out hexagon actors by coordinate and takes them back hidden instead of destroying them,
+ * so regenerating, highlighting and selecting reuse actors instead of spawning them.
+ * The free actors beyond the budget are destroyed a few per tick.
+ */
+UCLASS(Transient)
+class XKGAMEDEVCORE_API UXkHexagonActorPoolSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UXkHexagonActorPoolSubsystem();
+
+	static UXkHexagonActorPoolSubsystem* Get(const UWorld* InWorld);
+
+	// FTickableGameObject implementation Begin
+	virtual bool IsTickable() const override { return FreeActors.Num() > MaxFreeActorNum; }
+	virtual bool IsTickableInEditor() const override { return true; }
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	// FTickableGameObject implementation End
+
+	// UWorldSubsystem implementation Begin
+	virtual bool DoesSupportWorldType(EWorldType::Type WorldType) const override;
+	// UWorldSubsystem implementation End
+
+	// USubsystem implementation Begin
+	virtual void Deinitialize() override;
+	// USubsystem implementation End
+
+	/**
+	* @brief Spawn hidden actors until there are InNum free ones
+	*/
+	void Prewarm(const int32 InNum);
+
+	/**
+	* @brief Free actors kept beyond the largest budget of the hexagonal worlds are destroyed over the next ticks
+	* @param InNum Budget of this hexagonal world, the free actors are shared by every world of the level
+	*/
+	void SetMaxFreeActorNum(const AXkHexagonalWorldActor* InHexagonalWorld, const int32 InNum);
+
+	/**
+	* @brief Drop the budget of a hexagonal world leaving the level
+	*/
+	void ClearMaxFreeActorNum(const AXkHexagonalWorldActor* InHexagonalWorld);
+
+	/**
+	* @brief Place an actor at the coordinate of the hexagonal world, the actor already there is initialized again
+	* @return Actor of the coordinate, spawned only when the pool has no free actor
+	*/
+	AXkHexagonActor* Acquire(AXkHexagonalWorldActor* InHexagonalWorld, const FIntVector& InCoord);
+
+	/**
+	* @brief Hide the actor of the coordinate and give it back to the pool
+	*/
+	void Release(const AXkHexagonalWorldActor* InHexagonalWorld, const FIntVector& InCoord);
+
+	/**
+	* @brief Give every actor of the hexagonal world back to the pool
+	*/
+	void ReleaseAll(const AXkHexagonalWorldActor* InHexagonalWorld);
+
+	AXkHexagonActor* Find(const AXkHexagonalWorldActor* InHexagonalWorld, const FIntVector& InCoord) const;
+
+	int32 GetFreeActorNum() const { return FreeActors.Num(); };
+
+private:
+	AXkHexagonActor* SpawnFreeActor();
+	/* Largest budget of the worlds still alive, the default budget without any.*/
+	void UpdateMaxFreeActorNum();
+
+	// Actors are owned by the level, the pool only refers to them.
+	TMap<FObjectKey, TMap<FIntVector, TWeakObjectPtr<AXkHexagonActor>>> ActiveActors;
+	TArray<TWeakObjectPtr<AXkHexagonActor>> FreeActors;
+
+	TMap<FObjectKey, int32> WorldMaxFreeActorNums;
+	int32 DefaultMaxFreeActorNum;
+	int32 MaxFreeActorNum;
+	int32 MaxDestroyedActorsPerTick;
+};
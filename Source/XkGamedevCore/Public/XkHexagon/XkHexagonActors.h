@@ -5,6 +5,8 @@
 #include "CoreMinimal.h"
 #include "XkHexagonComponents.h"
 #include "XkHexagonPathfinding.h"
+#include "XkHexagonInfluence.h"
+#include "XkHexagonSnapshot.h"
 #include "XkHexagonActors.generated.h"
 
 // when EXkHexagonType is greater that AVAILABLEMARK,
@@ -12,8 +14,31 @@
 #define BASE_SECTION_INDEX 0
 #define EDGE_SECTION_INDEX 1
 
+// Custom primitive data of the hexagon base and edge colors, see bHexagonColorsInPrimitiveData.
+#define BASE_COLOR_PRIMITIVE_DATA_INDEX 0
+#define EDGE_COLOR_PRIMITIVE_DATA_INDEX 4
+
 class UProceduralMeshComponent;
 
+#if WITH_EDITOR
+/**
+ * Hexagon Proc Mesh Data
+ * Procedural hexagon geometry of the editor preview, built once per hexagonal world and shared by its actors.
+ */
+struct FXkHexagonProcMeshData
+{
+	TArray<FVector> BaseVertices;
+	TArray<int32> BaseIndices;
+	TArray<FVector2D> BaseUV0s;
+
+	TArray<FVector> EdgeVertices;
+	TArray<int32> EdgeIndices;
+	TArray<FVector2D> EdgeUV0s;
+
+	FBoxSphereBounds Bounds;
+};
+#endif
+
 UCLASS(BlueprintType, Blueprintable)
 class XKGAMEDEVCORE_API AXkHexagonActor : public AActor
 {
@@ -47,6 +72,7 @@ public:
 	//~ Begin AActor Interface
 	virtual void ConstructionScripts();
 	virtual void OnConstruction(const FTransform& Transform) override;
+	virtual void Destroyed() override;
 #if WITH_EDITOR
 	void PostEditMove(bool bFinished) override;
 #endif
@@ -54,29 +80,48 @@ public:
 
 	//~ Begin AXkHexagonActor Interface
 	virtual FIntVector GetCoord() const { return Coord; };
-	virtual void SetCoord(const FIntVector& Input) { Coord = Input; };
+	virtual void SetCoord(const FIntVector& Input);
 	virtual TWeakObjectPtr<class AXkHexagonalWorldActor> GetHexagonalWorld() const { return ParentHexagonalWorld; };
 	virtual void SetHexagonWorld(class AXkHexagonalWorldActor* Input);
 	virtual void OnBaseHighlight(const FLinearColor& InColor = FLinearColor::White);
 	virtual void OnEdgeHighlight(const FLinearColor& InColor = FLinearColor::White);
 	virtual UStaticMeshComponent* GetStaticProcMesh() const { return StaticProcMesh; };
+
+	/**
+	* @brief Apply only the hexagonal world properties which changed since this actor last applied them
+	*/
+	virtual void RefreshHexagon();
 	//~ End AXkHexagonActor Interface
 
 protected:
 
 	virtual void UpdateMaterial();
+	/* Colors go into the Color parameter of the material instance, or into custom primitive data when the actor has none.*/
+	virtual void SetHexagonColor(const int32 InDataIndex, const FLinearColor& InColor);
+	/* The material instance of the base or edge, the shared material when colors go into custom primitive data.*/
+	class UMaterialInterface* GetHexagonMaterial(const int32 InDataIndex) const;
 #if WITH_EDITOR
 	virtual void UpdateProcMesh();
 #endif
 	virtual void InitHexagon(const FIntVector& InCoord);
 	virtual void FreeHexagon();
 
+	/* Keep the coord index of the parent world pointing at this actor while it shows a hexagon.*/
+	void RegisterToHexagonalWorld();
+	void UnregisterFromHexagonalWorld();
+
+	friend class UXkHexagonActorPoolSubsystem;
+
 	UPROPERTY()
 	bool bCachedBaseHighlight;
 	UPROPERTY()
 	bool bCachedEdgeHighlight;
 	UPROPERTY()
 	TWeakObjectPtr<class AXkHexagonalWorldActor> ParentHexagonalWorld;
+
+	// Hashes of the hexagonal world properties last applied, zero when never applied.
+	uint32 AppliedColorHash;
+	uint32 AppliedGeometryHash;
 };
 
 
@@ -99,6 +144,10 @@ public:
 	UPROPERTY(EditAnywhere, Category = "HexagonalWorld [KEVINTSUIXUGAMEDEV]")
 	int32 BacktrackingMaxStep;
 
+	/* Path cost added per unit of danger influence on a coord, zero ignores the influence map.*/
+	UPROPERTY(EditAnywhere, Category = "HexagonalWorld [KEVINTSUIXUGAMEDEV]", meta = (ClampMin = "0.0"))
+	float PathfindingDangerCost;
+
 	UPROPERTY(EditAnywhere, Category = "HexagonalWorld [KEVINTSUIXUGAMEDEV]")
 	TObjectPtr<class AXkHexagonActor> HexagonStarter;
 
@@ -135,6 +184,11 @@ public:
 	UPROPERTY(EditAnywhere, Category = "HexagonalWorld [KEVINTSUIXUGAMEDEV]")
 	FLinearColor EdgeColor;
 
+	/* Hexagon actors share BaseMaterial and EdgeMaterial and write colors into custom primitive data 0 and 4, instead of
+	 * a material instance per actor. Only for materials whose Color reads the custom primitive data. */
+	UPROPERTY(EditAnywhere, Category = "HexagonalWorld [KEVINTSUIXUGAMEDEV]")
+	bool bHexagonColorsInPrimitiveData;
+
 	UPROPERTY(EditAnywhere, Category = "HexagonalWorld [KEVINTSUIXUGAMEDEV]")
 	int32 MaxManhattanDistance;
 
@@ -149,6 +203,7 @@ public:
 	//~ Begin Actor Interface
 	virtual void BeginPlay() override;
 	virtual void OnConstruction(const FTransform& Transform) override;
+	virtual void TickActor(float DeltaTime, enum ELevelTick TickType, FActorTickFunction& ThisTickFunction) override;
 	//~ End Actor Interface
 
 public:
@@ -180,16 +235,107 @@ public:
 
 	FORCEINLINE virtual FVector2D GetHexagonalWorldExtent() const;
 
+	/* Hash of the properties hexagon actors take their colors from.*/
+	uint32 GetHexagonColorHash() const;
+
+	/**
+	* @brief Color a whole path or range at once, the hexagonal world component of this actor gets a single batched update
+	* @param InCoords Coords to color, spawned hexagon actors of the coords take the color as well
+	*/
+	virtual void HighlightHexagons(const TArray<FIntVector>& InCoords, const FLinearColor& InColor);
+
+	/* Clear every highlight of the hexagonal world component and of the spawned hexagon actors.*/
+	virtual void ClearHexagonHighlights();
+
+	/* The properties hexagon actors build their geometry from.*/
+	FXkHexagonGeometryKey GetHexagonGeometryKey() const { return FXkHexagonGeometryKey(Radius, Height, BaseInnerGap, BaseOuterGap, EdgeInnerGap, EdgeOuterGap); };
+
+	uint32 GetHexagonGeometryHash() const { return GetTypeHash(GetHexagonGeometryKey()); };
+
+#if WITH_EDITOR
+	/* Built again only when the geometry hash changes.*/
+	const FXkHexagonProcMeshData& GetHexagonProcMeshData() const;
+#endif
+
+	/**
+	* @brief Find the hexagon actor showing a coordinate, the actors keep the index on init, free and destroy
+	*/
+	FORCEINLINE virtual AXkHexagonActor* FindHexagonActor(const FIntVector& InCoord) const;
+
+	/* The actors of the coords which have one, in the order of the coords.*/
+	FORCEINLINE virtual TArray<AXkHexagonActor*> FindHexagonActors(const TArray<FIntVector>& InCoords) const;
+
+	/* Every actor showing a hexagon of this world, free actors of the pool and other worlds are not indexed.*/
+	FORCEINLINE virtual TArray<AXkHexagonActor*> GetHexagonActors() const;
+
+	void RegisterHexagonActor(AXkHexagonActor* InHexagonActor);
+
+	void UnregisterHexagonActor(const AXkHexagonActor* InHexagonActor);
+
 	FORCEINLINE virtual FVector2D GetFullUnscaledWorldSize(const FVector2D& UnscaledPatchCoverage, const FVector2D& Resolution) const;
 
 	FORCEINLINE virtual void BuildHexagonData(TArray<FVector4f>& OutVertices, TArray<uint32>& OutIndices);
 
 	FORCEINLINE virtual TMap<FIntVector, FXkHexagonNode>& ModifyHexagonalWorldNodes() const { return HexagonalWorldTable.Nodes; };
 
+	/**
+	* @brief Every write through ModifyHexagonalWorldNodes or GetHexagonNode should be marked, or readers of the snapshot would not see it
+	*/
+	FORCEINLINE virtual void MarkHexagonNodeDirty(const FIntVector& InCoord, const EXkHexagonNodeField InFields = EXkHexagonNodeField::All) const { HexagonalWorldTable.MarkNodeDirty(InCoord, InFields); };
+
+	FORCEINLINE virtual void MarkHexagonalWorldDirty() const { HexagonalWorldTable.MarkAllNodesDirty(); };
+
+	/**
+	* @brief Start following the node table changes, see FXkHexagonalWorldChangeJournal
+	* @return Cursor handle used by ConsumeHexagonalWorldChanges
+	*/
+	FORCEINLINE virtual int32 SubscribeHexagonalWorldChanges() const { return HexagonalWorldTable.GetChangeJournal().Subscribe(); };
+
+	FORCEINLINE virtual void UnsubscribeHexagonalWorldChanges(const int32 InHandle) const { HexagonalWorldTable.GetChangeJournal().Unsubscribe(InHandle); };
+
+	/**
+	* @return False when the subscriber must rebuild from the whole table instead of applying OutChanges
+	*/
+	FORCEINLINE virtual bool ConsumeHexagonalWorldChanges(const int32 InHandle, TArray<FXkHexagonNodeChange>& OutChanges) const { return HexagonalWorldTable.GetChangeJournal().Consume(InHandle, OutChanges); };
+
+	/**
+	* @brief Publish pending node changes, called once per frame by TickActor
+	* @return Snapshot which render thread, pathfinding workers and save system could hold without locks
+	*/
+	virtual FXkHexagonalWorldSnapshotPtr PublishHexagonalWorldSnapshot() const;
+
+	FORCEINLINE virtual FXkHexagonalWorldSnapshotPtr GetHexagonalWorldSnapshot() const { return HexagonalWorldSnapshot; };
+
+	/**
+	* @brief Danger/control fields of the hexagonal world, stamp units here instead of looping over them per cell
+	*/
+	FORCEINLINE virtual FXkHexagonInfluenceMap& ModifyHexagonInfluenceMap() const { return HexagonInfluenceMap; };
+
+	FORCEINLINE virtual float GetHexagonInfluence(const EXkHexagonInfluenceLayer InLayer, const FIntVector& InCoord) const { return HexagonInfluenceMap.GetInfluence(InLayer, InCoord); };
+
+	/**
+	* @brief Cover a regenerated world with the influence map, the stamps are kept and stamped again
+	*/
+	void ResizeHexagonInfluenceMap(const int32 InMaxManhattanDistance) const { HexagonInfluenceMap.Resize(InMaxManhattanDistance); };
+
+protected:
+	FXkHexagonalWorldNodeTable* GetHexagonalWorldTable() const { return &HexagonalWorldTable; };
+
 private:
 	UPROPERTY(Transient)
 	mutable FXkHexagonalWorldNodeTable HexagonalWorldTable;
 
 	UPROPERTY(Transient)
 	mutable FXkHexagonAStarPathfinding HexagonAStarPathfinding;
+
+	mutable FXkHexagonInfluenceMap HexagonInfluenceMap;
+
+	mutable FXkHexagonalWorldSnapshotPtr HexagonalWorldSnapshot;
+
+	TMap<FIntVector, TWeakObjectPtr<AXkHexagonActor>> HexagonActorIndex;
+
+#if WITH_EDITOR
+	mutable FXkHexagonProcMeshData HexagonProcMeshData;
+	mutable uint32 HexagonProcMeshDataHash = 0;
+#endif
 };
\ No newline at end of file
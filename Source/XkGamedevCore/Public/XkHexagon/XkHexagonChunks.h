@@ -0,0 +1,103 @@
+// Copyright ©ICEPRINCE. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+#include "Containers/Queue.h"
+#include "XkHexagonPathfinding.h"
+
+/**
+ * Hexagon Chunk State
+ */
+enum class EXkHexagonChunkState : uint8
+{
+	Unloaded = 0,
+	Loading = 1,
+	Loaded = 2,
+};
+
+
+/**
+ * Hexagonal World Chunk Streamer
+ * Streams fixed size chunks of the node table in and out around a center coord.
+ * Chunks are generated or deserialized by the loader on worker threads and applied
+ * to the table on game thread, so the table never has to hold the whole world.
+ */
+class XKGAMEDEVCORE_API FXkHexagonalWorldChunkStreamer
+{
+public:
+	/* Fill the nodes of a chunk, called on worker threads so it must only read data it owns.*/
+	typedef TFunction<void(const FIntPoint& InChunkKey, TArray<FXkHexagonNode>& OutNodes)> FChunkLoader;
+
+	FXkHexagonalWorldChunkStreamer();
+	~FXkHexagonalWorldChunkStreamer();
+
+	/**
+	* @brief Start streaming into the table, the table is emptied and switched to chunked mode
+	* @param InTable The node table chunks are applied to
+	* @param InLoader Worker thread chunk loader
+	*/
+	void Initialize(FXkHexagonalWorldNodeTable* InTable, FChunkLoader&& InLoader);
+
+	/**
+	* @brief Wait for in-flight loads and stop streaming, the table keeps the loaded nodes
+	*/
+	void Shutdown();
+
+	bool IsStreaming() const { return HexagonalWorldTable != nullptr; };
+
+	/**
+	* @brief Request chunks around the center, unload chunks beyond the unload radius and apply finished loads
+	* @param InCenterCoord Coord the streaming is centered on, e.g. the top down camera
+	* @param InLoadRadius Chunks within this chunk distance are loaded
+	* @param InUnloadRadius Chunks beyond this chunk distance are unloaded, keep it greater than InLoadRadius
+	* @param InMaxAppliedChunks Finished chunks applied per call at most, bounds the game thread cost
+	* @param OutChangedChunks Optionally the keys of the chunks loaded or unloaded into the table
+	* @return Number of chunks loaded or unloaded into the table
+	*/
+	int32 Update(const FIntVector& InCenterCoord, const int32 InLoadRadius, const int32 InUnloadRadius, const int32 InMaxAppliedChunks = 4, TArray<FIntPoint>* OutChangedChunks = nullptr);
+
+	/**
+	* @brief Load a chunk out of the streaming radius, e.g. for a pathfinding target
+	*/
+	void RequestChunk(const FIntPoint& InChunkKey);
+
+	EXkHexagonChunkState GetChunkState(const FIntPoint& InChunkKey) const;
+
+	int32 GetLoadingChunkNum() const { return InFlightLoads.Num(); };
+
+private:
+	struct FChunk
+	{
+		EXkHexagonChunkState State = EXkHexagonChunkState::Unloaded;
+		uint32 Ticket = 0;
+	};
+
+	struct FChunkResult
+	{
+		FIntPoint ChunkKey;
+		uint32 Ticket;
+		TArray<FXkHexagonNode> Nodes;
+	};
+
+	struct FChunkLoad
+	{
+		uint32 Ticket;
+		TFuture<void> Future;
+	};
+
+	typedef TQueue<FChunkResult, EQueueMode::Mpsc> FChunkResultQueue;
+
+	void LoadChunk(const FIntPoint& InChunkKey, FChunk& InChunk);
+	void UnloadChunk(const FIntPoint& InChunkKey, FChunk& InChunk);
+
+	FXkHexagonalWorldNodeTable* HexagonalWorldTable;
+	TSharedPtr<FChunkLoader, ESPMode::ThreadSafe> ChunkLoader;
+	TSharedPtr<FChunkResultQueue, ESPMode::ThreadSafe> ChunkResults;
+	TMap<FIntPoint, FChunk> Chunks;
+	TMap<FIntPoint, FChunkLoad> InFlightLoads;
+	// Loads of chunks requested again while loading, only waited for by Shutdown.
+	TArray<TFuture<void>> SupersededLoads;
+	uint32 NextTicket;
+};
@@ -7,7 +7,10 @@
 #include "Components/PrimitiveComponent.h"
 #include "Components/ArrowComponent.h"
 #include "Components/InstancedStaticMeshComponent.h"
+#include "Containers/CircularQueue.h"
 #include "XkHexagonPathfinding.h"
+#include "XkHexagonSnapshot.h"
+#include "XkHexagonGeometry.h"
 #include "XkHexagonComponents.generated.h"
 
 
@@ -66,6 +69,99 @@ public:
 };
 
 
+/**
+ * Hexagon Highlight
+ * Instance colors of a highlighted hexagon, the hexagonal world scene proxy writes them into its palette indices.
+ */
+struct FXkHexagonHighlight
+{
+	FXkHexagonHighlight() : BaseColor(1.0f), EdgeColor(1.0f) {};
+	FXkHexagonHighlight(const FLinearColor& InBaseColor, const FLinearColor& InEdgeColor) : BaseColor(InBaseColor), EdgeColor(InEdgeColor) {};
+
+	bool operator==(const FXkHexagonHighlight& Other) const { return BaseColor == Other.BaseColor && EdgeColor == Other.EdgeColor; };
+	bool operator!=(const FXkHexagonHighlight& Other) const { return !(*this == Other); };
+
+	FVector4f BaseColor;
+	FVector4f EdgeColor;
+};
+
+typedef TMap<FIntVector, FXkHexagonHighlight> FXkHexagonHighlightMap;
+
+
+/**
+ * Hexagon Highlight Layer
+ * Highlights of one purpose, like a path preview, a move range or an attack range.
+ * Where layers overlap the one of the highest priority shows, on equal priority the name sorting first.
+ */
+struct FXkHexagonHighlightLayer
+{
+	FXkHexagonHighlightLayer() : Priority(0) {};
+
+	int32 Priority;
+	FXkHexagonHighlightMap Highlights;
+};
+
+
+/**
+ * Hexagon Highlight Change
+ * Shown highlight of a coord after its layers changed, sent to the scene proxy instead of every highlight.
+ */
+struct FXkHexagonHighlightChange
+{
+	FXkHexagonHighlightChange(const FIntVector& InCoord) : Coord(InCoord), bCleared(true) {};
+	FXkHexagonHighlightChange(const FIntVector& InCoord, const FXkHexagonHighlight& InHighlight) : Coord(InCoord), bCleared(false), Highlight(InHighlight) {};
+
+	FIntVector Coord;
+	bool bCleared;
+	FXkHexagonHighlight Highlight;
+};
+
+
+/**
+ * Hexagonal World Render Update
+ * Everything the component changed in one tick, the scene proxy applies it without reading the component.
+ */
+struct FXkHexagonalWorldRenderUpdate
+{
+	FXkHexagonalWorldRenderUpdate() : bFullSync(false), bVisibilityChanged(false), bShowBaseMesh(false), bShowEdgeMesh(false) {};
+
+	bool HasChanges() const { return Snapshot.IsValid() || HighlightChanges.Num() > 0 || bVisibilityChanged; };
+
+	// New snapshot of the node table, the proxy looks up the changed nodes in it.
+	FXkHexagonalWorldSnapshotPtr Snapshot;
+	// Nodes changed since the previous snapshot, from the change journal of the node table.
+	TArray<FXkHexagonNodeChange> NodeChanges;
+	// The journal could not tell what changed, the proxy diffs every page of the snapshot instead.
+	bool bFullSync;
+	TArray<FXkHexagonHighlightChange> HighlightChanges;
+	bool bVisibilityChanged;
+	bool bShowBaseMesh;
+	bool bShowEdgeMesh;
+};
+
+
+/**
+ * Hexagonal World Render Channel
+ * Lock-free single producer single consumer ring between one component on game thread and its scene proxy,
+ * which drains it once per frame on render thread. Shared by both, so either side may go away first.
+ */
+class FXkHexagonalWorldRenderChannel
+{
+public:
+	explicit FXkHexagonalWorldRenderChannel(const uint32 InCapacity) : Updates(InCapacity) {};
+
+	/* Game thread only, false when the ring is full and the update stays with the caller.*/
+	bool Enqueue(FXkHexagonalWorldRenderUpdate&& InUpdate) { return Updates.Enqueue(MoveTemp(InUpdate)); };
+	/* Render thread only.*/
+	bool Dequeue(FXkHexagonalWorldRenderUpdate& OutUpdate) { return Updates.Dequeue(OutUpdate); };
+
+private:
+	TCircularQueue<FXkHexagonalWorldRenderUpdate> Updates;
+};
+
+typedef TSharedPtr<FXkHexagonalWorldRenderChannel, ESPMode::ThreadSafe> FXkHexagonalWorldRenderChannelPtr;
+
+
 UCLASS(BlueprintType, Blueprintable, ClassGroup = XkGamedevCore, ShowCategories = (VirtualTexture), meta = (BlueprintSpawnableComponent, DisplayName = "XkHexagonalWorldComponent"))
 class XKGAMEDEVCORE_API UXkHexagonalWorldComponent : public UPrimitiveComponent
 {
@@ -115,18 +211,80 @@ public:
 	virtual FPrimitiveSceneProxy* CreateSceneProxy() override;
 	virtual FBoxSphereBounds CalcBounds(const FTransform& LocalToWorld) const override;
 	virtual void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+	virtual void OnComponentDestroyed(bool bDestroyingHierarchy) override;
 	FMaterialRelevance GetMaterialRelevance(ERHIFeatureLevel::Type InFeatureLevel) const;
 	virtual void GetUsedMaterials(TArray<UMaterialInterface*>& OutMaterials, bool bGetDebugMaterials = false) const override;
 	//~ End UPrimitiveComponent interface
 
-	virtual void InitHexagonalWorldTable(FXkHexagonalWorldNodeTable* Input) { HexagonalWorldTable = Input; };
+	/**
+	* @brief Follow a node table, the component subscribes to its change journal to send only the changed nodes to the proxy
+	*/
+	virtual void InitHexagonalWorldTable(FXkHexagonalWorldNodeTable* Input);
 	const TMap<FIntVector, FXkHexagonNode>& ModifyHexagonalWorldNodes() const { check(HexagonalWorldTable); return HexagonalWorldTable->Nodes; };
+	/* Latest published snapshot of the node table, safe to hand over to other threads.*/
+	FXkHexagonalWorldSnapshotPtr GetHexagonalWorldSnapshot() const { return HexagonalWorldSnapshot; };
 	virtual void BuildHexagonData(TArray<FVector4f>& OutVertices, TArray<uint32>& OutIndices);
+	FXkHexagonGeometryKey GetHexagonGeometryKey() const { return FXkHexagonGeometryKey(Radius, Height, BaseInnerGap, BaseOuterGap, EdgeInnerGap, EdgeOuterGap); };
 	virtual FVector2D GetHexagonalWorldExtent() const;
 	virtual FVector2D GetFullUnscaledWorldSize(const FVector2D& UnscaledPatchCoverage, const FVector2D& Resolution) const;
 
+	/**
+	* @brief Color a whole path or range, drawn by the instance palette indices in the same draw as the other hexagons
+	* @param InCoords Every coord is colored by the same update, sent to the render thread once per frame
+	*/
+	virtual void SetHexagonHighlights(const TArray<FIntVector>& InCoords, const FLinearColor& InBaseColor, const FLinearColor& InEdgeColor);
+	virtual void ClearHexagonHighlights(const TArray<FIntVector>& InCoords);
+	virtual void ClearAllHexagonHighlights();
+
+	/**
+	* @brief Color coords on a layer, the default layer NAME_None has priority 0
+	* @param InPriority Priority of the whole layer, where layers overlap the highest one shows.
+	* Layers of the same priority show the one whose name sorts first, compared case insensitive like FName::Compare.
+	*/
+	virtual void SetHexagonLayerHighlights(const FName InLayer, const int32 InPriority, const TArray<FIntVector>& InCoords, const FLinearColor& InBaseColor, const FLinearColor& InEdgeColor);
+	virtual void ClearHexagonLayerHighlights(const FName InLayer, const TArray<FIntVector>& InCoords);
+	/**
+	* @brief Clear every coord of the layer, the layers below show again where they overlapped
+	*/
+	virtual void ClearHexagonHighlightLayer(const FName InLayer);
+
+	/* Shown highlight of every coord, the layers resolved by priority.*/
+	const FXkHexagonHighlightMap& GetHexagonHighlights() const { return HexagonHighlights; };
+
+	/**
+	* @brief Show or hide the base or edge meshes of every hexagon, the scene proxy picks it up next frame
+	*/
+	virtual void SetShowBaseMesh(const bool bInShow);
+	virtual void SetShowEdgeMesh(const bool bInShow);
+
+	/* Channel of the current scene proxy, made again with every proxy.*/
+	FXkHexagonalWorldRenderChannelPtr GetRenderChannel() const { return RenderChannel; };
+
 private:
+	/* Resolve the coords changed since the last call, the shown highlights that changed are added to the output.*/
+	void ResolveHexagonHighlights(TArray<FXkHexagonHighlightChange>& OutChanges);
+	/* Move the pending update into the channel, when the ring is full it waits for the next tick.*/
+	void FlushRenderUpdates();
+	/* Fold a tick of changes into the pending update, later changes of a coord replace or extend the earlier ones.*/
+	void MergePendingRenderUpdate(FXkHexagonalWorldRenderUpdate&& InUpdate);
+	void ResetPendingRenderUpdate();
+	/* Publish the node table and take the journal changes since the last snapshot, false when the journal cannot tell them.*/
+	bool ConsumeNodeChanges(TArray<FXkHexagonNodeChange>& OutChanges);
+
 	FXkHexagonalWorldNodeTable* HexagonalWorldTable;
+	FXkHexagonalWorldSnapshotPtr HexagonalWorldSnapshot;
+	int32 ChangeJournalHandle;
+
+	TMap<FName, FXkHexagonHighlightLayer> HighlightLayers;
+	FXkHexagonHighlightMap HexagonHighlights;
+	TSet<FIntVector> DirtyHighlightCoords;
+
+	FXkHexagonalWorldRenderChannelPtr RenderChannel;
+	// Ticks the full ring could not take, merged into one update holding at most one change per coord.
+	FXkHexagonalWorldRenderUpdate PendingRenderUpdate;
+	TMap<FIntVector, int32> PendingNodeChangeIndices;
+	TMap<FIntVector, int32> PendingHighlightChangeIndices;
+	bool bRenderVisibilityDirty;
 };
 
 
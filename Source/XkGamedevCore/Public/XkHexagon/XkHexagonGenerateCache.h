@@ -0,0 +1,50 @@
+// Copyright ©ICEPRINCE. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "XkHexagonGenerator.h"
+
+/**
+ * Hexagonal World Generate Cache
+ * Generated grids on disk in the hexagonal world file format, named by the hash of every generate input,
+ * so switching back to settings generated before maps the file instead of generating again.
+ * Safe to use from worker threads, files are written under a temporary name and moved in place.
+ */
+class XKGAMEDEVCORE_API FXkHexagonalWorldGenerateCache
+{
+public:
+	/**
+	* @param InDirectory Cache directory, GetDefaultDirectory when empty
+	* @param InMaxEntryNum Least recently used files beyond this number are deleted on save
+	*/
+	explicit FXkHexagonalWorldGenerateCache(const FString& InDirectory = FString(), const int32 InMaxEntryNum = 16);
+
+	/* Saved/XkHexagonalWorldCache of the project.*/
+	static FString GetDefaultDirectory();
+
+	/**
+	* @brief Hash of the generate settings, the generator version and the file version, the extra inputs are hashed as well
+	* so inputs read outside of the generator still tell cache entries apart
+	*/
+	static FString MakeKey(const FXkHexagonalWorldGenerateSettings& InSettings, const TArray<uint8>& InExtraInputs = TArray<uint8>());
+
+	FString GetFilename(const FString& InKey) const;
+
+	/**
+	* @brief Fill the grid from the cache entry, GeneratedSettings of the grid becomes InSettings
+	* @return False on a cache miss
+	*/
+	bool Load(const FString& InKey, const FXkHexagonalWorldGenerateSettings& InSettings, FXkHexagonalWorldGrid& OutGrid) const;
+
+	/**
+	* @brief Write a complete grid as the cache entry and drop the least recently used entries
+	*/
+	bool Save(const FString& InKey, const FXkHexagonalWorldGrid& InGrid) const;
+
+private:
+	void Prune() const;
+
+	FString Directory;
+	int32 MaxEntryNum;
+};
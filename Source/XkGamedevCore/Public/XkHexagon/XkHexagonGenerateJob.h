@@ -0,0 +1,88 @@
+// Copyright ©ICEPRINCE. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+#include "XkHexagonGenerator.h"
+
+/**
+ * Hexagonal World Generate Result
+ * Everything a regenerated world needs on game thread, built on a worker so the swap is only moves.
+ */
+struct FXkHexagonalWorldGenerateResult
+{
+	FXkHexagonalWorldGrid Grid;
+	TMap<FIntVector, FXkHexagonNode> Nodes;
+	// Canvas instances, same order as the nodes.
+	TArray<FVector4f> InstancePositions;
+	TArray<FVector4f> InstanceWeights;
+	FXkHexagonGenerateStats Stats;
+	// Restored from the generate cache instead of generated.
+	bool bFromCache = false;
+};
+
+typedef TSharedPtr<FXkHexagonalWorldGenerateResult, ESPMode::ThreadSafe> FXkHexagonalWorldGenerateResultPtr;
+
+
+/**
+ * Hexagonal World Generate Job
+ * Runs the generator on a worker thread. Starting a new job cancels the running one, a cancelled
+ * worker stops at its next step and its result is never seen, so callers never wait on it.
+ */
+class XKGAMEDEVCORE_API FXkHexagonalWorldGenerateJob
+{
+public:
+	FXkHexagonalWorldGenerateJob();
+	~FXkHexagonalWorldGenerateJob();
+
+	/**
+	* @brief Cancel the running job and generate with the new settings
+	* @param InSettings Copied, the worker never reads the actor
+	* @param InCacheKey Generate cache entry to restore instead of generating, and to save the generated grid into, no cache when empty
+	*/
+	void Start(const FXkHexagonalWorldGenerateSettings& InSettings, const FString& InCacheKey = FString());
+
+	void Cancel();
+
+	bool IsRunning() const { return State.IsValid() && !State->bFinished; };
+
+	/* Finished and not taken yet.*/
+	bool IsReady() const { return State.IsValid() && State->bFinished && State->Result.IsValid(); };
+
+	/* Progress of the current job in [0, 1], 1 when there is none.*/
+	float GetProgress() const;
+
+	/**
+	* @brief Take the result of a finished job, the job is idle afterwards
+	* @return Null when the job is not ready
+	*/
+	FXkHexagonalWorldGenerateResultPtr TakeResult();
+
+	/**
+	* @brief Canvas instance data of the nodes, the order of the canvas draw is the order of the nodes
+	* @param InBounds Only the nodes positioned inside, all nodes when null
+	*/
+	static void BuildCanvasInstances(const TMap<FIntVector, FXkHexagonNode>& InNodes, TArray<FVector4f>& OutPositions, TArray<FVector4f>& OutWeights, const FBox2D* InBounds = nullptr);
+
+private:
+	struct FState
+	{
+		FState() : bCancelled(false), bFinished(false), CompletedSteps(0) {};
+
+		TAtomic<bool> bCancelled;
+		TAtomic<bool> bFinished;
+		TAtomic<int32> CompletedSteps;
+		FXkHexagonalWorldGenerateResultPtr Result;
+	};
+
+	typedef TSharedPtr<FState, ESPMode::ThreadSafe> FStatePtr;
+
+	static void Run(const FXkHexagonalWorldGenerateSettings& InSettings, const FString& InCacheKey, const FStatePtr& InState);
+
+	// Every generate stage, then the node table and the canvas instances.
+	static constexpr int32 StepNum = (int32)EXkHexagonGenerateStage::Num + 2;
+
+	FStatePtr State;
+	TFuture<void> Future;
+};
@@ -0,0 +1,211 @@
+// Copyright ©ICEPRINCE. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "XkHexagonPathfinding.h"
+
+// Bump whenever the same settings generate other nodes, cached worlds of older generators are not loaded.
+#define HEXAGON_GENERATOR_VERSION 2
+
+/**
+ * Hexagonal World Generate Settings
+ * Copy of the generate properties, owned by generators running on worker threads.
+ */
+struct FXkHexagonalWorldGenerateSettings
+{
+	FXkHexagonalWorldGenerateSettings() : Radius(100.0f), GapWidth(0.0f), GroundManhattanDistance(0), ShorelineManhattanDistance(0), WorldSeed(0), HeightNoiseSize(0.0f) {};
+
+	float Radius;
+	float GapWidth;
+	int32 GroundManhattanDistance;
+	int32 ShorelineManhattanDistance;
+	int32 WorldSeed;
+	// World size of one FBM noise cell for the splat noise heights, no noise when zero.
+	float HeightNoiseSize;
+	TArray<FXkHexagonSplat> HexagonSplats;
+
+	/* Every node is within this distance of the center.*/
+	int32 GetMaxManhattanDistance() const { return FMath::Max(GroundManhattanDistance + ShorelineManhattanDistance - 1, 0); };
+
+	/* Nodes are the coords closer than this to the center.*/
+	int32 GetOuterManhattanDistance() const { return FMath::Max(GroundManhattanDistance + ShorelineManhattanDistance, 0); };
+
+	/**
+	* @brief Generate a single node through every stage, same result as the node of a generated grid
+	* @return False when there is no hexagon at the coord
+	*/
+	bool GenerateNode(const FIntVector& InCoord, FXkHexagonNode& OutNode) const;
+};
+
+
+/**
+ * Hexagon Generate Stage
+ */
+enum class EXkHexagonGenerateStage : uint8
+{
+	Layout = 0,         // which coords hold a hexagon and where
+	Classification = 1, // hexagon type
+	HeightSplat = 2,    // height and splat of the type
+	PostProcess = 3,    // compact the valid cells in coord order
+	Num = 4,
+};
+
+
+/**
+ * Hexagon Generate Band
+ * Cells a stage has to run on, the whole grid or rings of manhattan distance to the center.
+ */
+struct FXkHexagonGenerateBand
+{
+	FXkHexagonGenerateBand() : bAll(false) {};
+
+	static FXkHexagonGenerateBand All() { FXkHexagonGenerateBand Band; Band.bAll = true; return Band; };
+
+	/* Add the rings in [InMin, InMax), either order.*/
+	void Add(const int32 InMin, const int32 InMax)
+	{
+		if (InMin != InMax)
+		{
+			Ranges.Add(FIntPoint(FMath::Min(InMin, InMax), FMath::Max(InMin, InMax)));
+		}
+	};
+
+	void Add(const FXkHexagonGenerateBand& InBand)
+	{
+		bAll |= InBand.bAll;
+		Ranges.Append(InBand.Ranges);
+	};
+
+	bool IsEmpty() const { return !bAll && Ranges.Num() == 0; };
+
+	FORCEINLINE bool Contains(const int32 InManhattanDistance) const
+	{
+		if (bAll)
+		{
+			return true;
+		}
+		for (const FIntPoint& Range : Ranges)
+		{
+			if (InManhattanDistance >= Range.X && InManhattanDistance < Range.Y)
+			{
+				return true;
+			}
+		}
+		return false;
+	};
+
+	bool bAll;
+	TArray<FIntPoint, TInlineAllocator<4>> Ranges;
+};
+
+
+/**
+ * Hexagonal World Grid
+ * Dense generate storage, cell of cube coord (X, Y) is (X + R) * Pitch + (Y + R) and a zero type is no node.
+ */
+struct XKGAMEDEVCORE_API FXkHexagonalWorldGrid
+{
+	FXkHexagonalWorldGrid() : MaxManhattanDistance(0), Pitch(0), CompletedStageNum(0) {};
+
+	void Allocate(const int32 InMaxManhattanDistance);
+
+	/**
+	* @brief Change the grid size and keep the cells covered by both sizes
+	*/
+	void Resize(const int32 InMaxManhattanDistance);
+
+	FORCEINLINE int32 GetCellIndex(const int32 X, const int32 Y) const { return (X + MaxManhattanDistance) * Pitch + (Y + MaxManhattanDistance); };
+	FORCEINLINE FIntVector GetCoord(const int32 InCellIndex) const
+	{
+		const int32 X = InCellIndex / Pitch - MaxManhattanDistance;
+		const int32 Y = InCellIndex % Pitch - MaxManhattanDistance;
+		return FIntVector(X, Y, -X - Y);
+	};
+
+	FXkHexagonNode MakeNode(const int32 InCellIndex) const;
+
+	/**
+	* @brief Write every node into the table in coord order
+	*/
+	void FillNodes(TMap<FIntVector, FXkHexagonNode>& OutNodes) const;
+
+	int32 MaxManhattanDistance;
+	int32 Pitch;
+	TArray<uint8> Types;
+	TArray<uint8> Splats;
+	TArray<FVector4f> Positions;
+	TArray<FVector4f> CustomData;
+	// Valid cells in coord order, written by the post process stage.
+	TArray<int32> NodeCells;
+
+	// Settings of the generated cells and how many stages ran in order, the grid is complete when every stage ran.
+	FXkHexagonalWorldGenerateSettings GeneratedSettings;
+	int32 CompletedStageNum;
+};
+
+
+struct FXkHexagonGenerateStats
+{
+	FXkHexagonGenerateStats() : NodeNum(0) { FMemory::Memzero(StageSeconds); };
+
+	double StageSeconds[(int32)EXkHexagonGenerateStage::Num];
+	int32 NodeNum;
+};
+
+
+/**
+ * Hexagonal World Generator
+ * Staged procedural generation into a dense grid. Every stage runs ParallelFor over grid rows and every
+ * cell only depends on its coord and the settings, so the result is the same for any thread count.
+ */
+class XKGAMEDEVCORE_API FXkHexagonalWorldGenerator
+{
+public:
+	explicit FXkHexagonalWorldGenerator(const FXkHexagonalWorldGenerateSettings& InSettings);
+
+	/**
+	* @brief Run the stages from InFirstStage to InLastStage, the grid is allocated by the layout stage
+	* @param OutGrid Grid to generate into
+	* @param OutStats Optional per stage timings
+	*/
+	void Generate(FXkHexagonalWorldGrid& OutGrid, FXkHexagonGenerateStats* OutStats = nullptr,
+		const EXkHexagonGenerateStage InFirstStage = EXkHexagonGenerateStage::Layout, const EXkHexagonGenerateStage InLastStage = EXkHexagonGenerateStage::PostProcess) const;
+
+	/**
+	* @brief Run a stage on the cells of the band only, the post process stage always runs on the whole grid
+	*/
+	void RunStage(const EXkHexagonGenerateStage InStage, FXkHexagonalWorldGrid& InOutGrid, const FXkHexagonGenerateBand& InBand = FXkHexagonGenerateBand::All()) const;
+
+	/**
+	* @brief Bring a complete grid generated with other settings up to date, a stage only runs again on the cells
+	* whose inputs changed, e.g. splat changes only run the height splat stage and a larger world only lays out new rings.
+	* @param InOutGrid Grid to update, generated from scratch when nothing of it could be reused
+	* @param OutChangedCoords Coords whose node changed, was added or was removed
+	* @param OutStats Optional per stage timings, zero for the skipped stages
+	* @return False when the whole grid was generated from scratch
+	*/
+	bool Regenerate(FXkHexagonalWorldGrid& InOutGrid, TArray<FIntVector>& OutChangedCoords, FXkHexagonGenerateStats* OutStats = nullptr) const;
+
+	/**
+	* @return Hash of the settings a stage reads apart from the world size, which is tracked as bands instead
+	*/
+	static uint32 GetStageHash(const FXkHexagonalWorldGenerateSettings& InSettings, const EXkHexagonGenerateStage InStage);
+
+	static const TCHAR* GetStageName(const EXkHexagonGenerateStage InStage);
+
+	// Per cell stages, shared by the row passes and GenerateNode.
+	static bool LayoutCell(const FXkHexagonalWorldGenerateSettings& InSettings, const FIntVector& InCoord, uint8& OutType, FVector4f& OutPosition);
+	static uint8 ClassifyCell(const FXkHexagonalWorldGenerateSettings& InSettings, const FIntVector& InCoord);
+	static void HeightSplatCell(const FXkHexagonalWorldGenerateSettings& InSettings, const uint8 InType, const uint32 InRandom, const float InHeightNoise, FVector4f& InOutPosition, uint8& OutSplat);
+	/* FBM terrain noise of the hexagon position, the same value FXkNoiseFBM::FBMSimulateBatch gives the row passes.*/
+	static float HeightNoiseCell(const FXkHexagonalWorldGenerateSettings& InSettings, const FVector4f& InPosition);
+
+private:
+	void RunLayout(FXkHexagonalWorldGrid& InOutGrid, const FXkHexagonGenerateBand& InBand) const;
+	void RunClassification(FXkHexagonalWorldGrid& InOutGrid, const FXkHexagonGenerateBand& InBand) const;
+	void RunHeightSplat(FXkHexagonalWorldGrid& InOutGrid, const FXkHexagonGenerateBand& InBand) const;
+	void RunPostProcess(FXkHexagonalWorldGrid& InOutGrid) const;
+
+	FXkHexagonalWorldGenerateSettings Settings;
+};
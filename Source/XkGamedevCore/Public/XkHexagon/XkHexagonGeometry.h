@@ -0,0 +1,132 @@
+// Copyright ©ICEPRINCE. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RenderResource.h"
+
+// Center, 6 top boundary vertices and 6 side quads
+#define HEXAGON_BASE_VERTEX_NUM 31
+#define HEXAGON_BASE_INDEX_NUM 54
+// 6 boundary quads
+#define HEXAGON_EDGE_VERTEX_NUM 24
+#define HEXAGON_EDGE_INDEX_NUM 36
+// First 3 boundary quads, the neighbours draw the sides facing them when they draw edges at all
+#define HEXAGON_EDGE_LOD1_INDEX_NUM 18
+
+
+/**
+ * Hexagon Geometry Key
+ * Every parameter the base and edge meshes of a hexagon are built from.
+ */
+struct XKGAMEDEVCORE_API FXkHexagonGeometryKey
+{
+	FXkHexagonGeometryKey(const float InRadius, const float InHeight, const float InBaseInnerGap, const float InBaseOuterGap, const float InEdgeInnerGap, const float InEdgeOuterGap) :
+		Radius(InRadius), Height(InHeight), BaseInnerGap(InBaseInnerGap), BaseOuterGap(InBaseOuterGap), EdgeInnerGap(InEdgeInnerGap), EdgeOuterGap(InEdgeOuterGap) {};
+
+	bool operator==(const FXkHexagonGeometryKey& Other) const
+	{
+		return Radius == Other.Radius && Height == Other.Height
+			&& BaseInnerGap == Other.BaseInnerGap && BaseOuterGap == Other.BaseOuterGap
+			&& EdgeInnerGap == Other.EdgeInnerGap && EdgeOuterGap == Other.EdgeOuterGap;
+	};
+
+	friend uint32 GetTypeHash(const FXkHexagonGeometryKey& InKey)
+	{
+		uint32 Hash = HashCombine(GetTypeHash(InKey.Radius), GetTypeHash(InKey.Height));
+		Hash = HashCombine(Hash, HashCombine(GetTypeHash(InKey.BaseInnerGap), GetTypeHash(InKey.BaseOuterGap)));
+		return HashCombine(Hash, HashCombine(GetTypeHash(InKey.EdgeInnerGap), GetTypeHash(InKey.EdgeOuterGap)));
+	};
+
+	float Radius;
+	float Height;
+	float BaseInnerGap;
+	float BaseOuterGap;
+	float EdgeInnerGap;
+	float EdgeOuterGap;
+};
+
+
+/**
+ * Hexagon Geometry Vertex Buffer
+ * Base vertices followed by edge vertices, so the edge mesh starts at HEXAGON_BASE_VERTEX_NUM.
+ */
+class XKGAMEDEVCORE_API FXkHexagonGeometryVertexBuffer : public FVertexBuffer
+{
+public:
+	virtual void InitRHI() override;
+
+	TArray<FVector4f> Vertices;
+};
+
+
+class XKGAMEDEVCORE_API FXkHexagonGeometryIndexBuffer : public FIndexBuffer
+{
+public:
+	virtual void InitRHI() override;
+
+	TArray<uint32> Indices;
+};
+
+
+/**
+ * Hexagon Geometry
+ * Immutable base and edge meshes of one hexagon with their render resources,
+ * shared by every scene proxy, canvas draw and editor preview built from the same key.
+ */
+class XKGAMEDEVCORE_API FXkHexagonGeometry
+{
+public:
+	explicit FXkHexagonGeometry(const FXkHexagonGeometryKey& InKey);
+	~FXkHexagonGeometry();
+
+	const FXkHexagonGeometryKey& GetKey() const { return Key; };
+
+	const TArray<FVector4f>& GetBaseVertices() const { return BaseVertices; };
+	const TArray<uint32>& GetBaseIndices() const { return BaseIndices; };
+	const TArray<FVector4f>& GetEdgeVertices() const { return EdgeVertices; };
+	const TArray<uint32>& GetEdgeIndices() const { return EdgeIndices; };
+
+	/* Render thread only, their init is enqueued before any proxy holding the geometry could draw.*/
+	FVertexBuffer* GetVertexBuffer() const { return &Resources->VertexBuffer; };
+	FIndexBuffer* GetBaseIndexBuffer() const { return &Resources->BaseIndexBuffer; };
+	FIndexBuffer* GetEdgeIndexBuffer() const { return &Resources->EdgeIndexBuffer; };
+
+	/**
+	* @brief Build the meshes into arrays reserved to their exact size
+	*/
+	static void Build(const FXkHexagonGeometryKey& InKey, TArray<FVector4f>& OutBaseVertices, TArray<uint32>& OutBaseIndices, TArray<FVector4f>& OutEdgeVertices, TArray<uint32>& OutEdgeIndices);
+
+private:
+	struct FResources
+	{
+		FXkHexagonGeometryVertexBuffer VertexBuffer;
+		FXkHexagonGeometryIndexBuffer BaseIndexBuffer;
+		FXkHexagonGeometryIndexBuffer EdgeIndexBuffer;
+	};
+
+	const FXkHexagonGeometryKey Key;
+	TArray<FVector4f> BaseVertices;
+	TArray<uint32> BaseIndices;
+	TArray<FVector4f> EdgeVertices;
+	TArray<uint32> EdgeIndices;
+
+	// Released on render thread after the last holder is gone, wherever that was.
+	FResources* Resources;
+};
+
+typedef TSharedPtr<const FXkHexagonGeometry, ESPMode::ThreadSafe> FXkHexagonGeometryPtr;
+
+
+/**
+ * Hexagon Geometry Cache
+ * Geometries by key, alive while anyone holds them.
+ */
+class XKGAMEDEVCORE_API FXkHexagonGeometryCache
+{
+public:
+	/**
+	* @brief Find or build the geometry of the key, a new geometry enqueues the init of its render resources
+	*/
+	static FXkHexagonGeometryPtr Get(const FXkHexagonGeometryKey& InKey);
+};
@@ -0,0 +1,129 @@
+// Copyright ©ICEPRINCE. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "XkHexagonPathfinding.h"
+
+/**
+ * Hexagon Influence Layer
+ */
+enum class EXkHexagonInfluenceLayer : uint8
+{
+	Danger = 0,
+	Control = 1,
+	Num = 2,
+};
+
+
+/**
+ * Hexagon Influence Stamp
+ * One unit's contribution to an influence layer, falling off linearly
+ * from Strength at Coord to zero one ring beyond Radius.
+ */
+struct FXkHexagonInfluenceStamp
+{
+	FXkHexagonInfluenceStamp() : Coord(FIntVector::ZeroValue), Radius(0), Strength(0.0f), Layer(EXkHexagonInfluenceLayer::Danger) {};
+	FXkHexagonInfluenceStamp(const FIntVector& InCoord, const int32 InRadius, const float InStrength, const EXkHexagonInfluenceLayer InLayer) :
+		Coord(InCoord), Radius(InRadius), Strength(InStrength), Layer(InLayer) {};
+
+	FIntVector Coord;
+	int32 Radius;
+	float Strength;
+	EXkHexagonInfluenceLayer Layer;
+};
+
+
+/**
+ * Hexagon Influence Snapshot
+ * Immutable copy of the influence layers, safe to read from worker threads.
+ */
+struct XKGAMEDEVCORE_API FXkHexagonInfluenceSnapshot
+{
+	FXkHexagonInfluenceSnapshot() : MaxManhattanDistance(0), Pitch(0), Version(0) {};
+
+	float GetInfluence(const EXkHexagonInfluenceLayer InLayer, const FIntVector& InCoord) const;
+
+	int32 MaxManhattanDistance;
+	int32 Pitch;
+	uint32 Version;
+	TArray<float> Layers[(int32)EXkHexagonInfluenceLayer::Num];
+};
+
+
+/**
+ * Hexagon Influence Map
+ * Dense influence fields over the hexagonal world, indexed by cube coord (X, Y).
+ * Stamps are applied and removed incrementally, so moving a unit only touches
+ * the cells inside its old and new radius.
+ */
+class XKGAMEDEVCORE_API FXkHexagonInfluenceMap
+{
+public:
+	FXkHexagonInfluenceMap();
+	~FXkHexagonInfluenceMap();
+
+	/**
+	* @brief Allocate layers covering every coord within InMaxManhattanDistance of the center, drop all stamps
+	* @param InMaxManhattanDistance The hexagonal world radius
+	*/
+	void Initialize(const int32 InMaxManhattanDistance);
+
+	/**
+	* @brief Cover another world radius and re-stamp every stamp, cells outside the new radius are clipped
+	* @param InMaxManhattanDistance The hexagonal world radius, nothing is done when it is unchanged
+	*/
+	void Resize(const int32 InMaxManhattanDistance);
+
+	/**
+	* @brief Stamp a unit into its layer
+	* @return Handle used to move or remove the stamp later
+	*/
+	int32 AddStamp(const FXkHexagonInfluenceStamp& InStamp);
+
+	/**
+	* @brief Un-stamp the old stamp and re-stamp the new one, only the two radii are touched
+	*/
+	void UpdateStamp(const int32 InHandle, const FXkHexagonInfluenceStamp& InStamp);
+
+	void MoveStamp(const int32 InHandle, const FIntVector& InCoord);
+
+	void RemoveStamp(const int32 InHandle);
+
+	/**
+	* @brief Clear the layers and re-stamp everything, flushes float drift accumulated by incremental updates
+	*/
+	void Rebuild();
+
+	float GetInfluence(const EXkHexagonInfluenceLayer InLayer, const FIntVector& InCoord) const;
+
+	/**
+	* @brief Copy the layers into an immutable snapshot, the copy is reused until a stamp changes
+	* @return Snapshot which worker threads could hold and read without locks
+	*/
+	TSharedRef<const FXkHexagonInfluenceSnapshot, ESPMode::ThreadSafe> PublishSnapshot();
+
+	int32 GetMaxManhattanDistance() const { return MaxManhattanDistance; };
+	uint32 GetVersion() const { return Version; };
+
+private:
+	struct FInfluenceKernel
+	{
+		// Per row (cube X offset) of the stamp, first cube Y offset and the offset into Weights.
+		TArray<int32> RowMinY;
+		TArray<int32> RowOffsets;
+		TArray<float> Weights;
+	};
+
+	void ApplyStamp(const FXkHexagonInfluenceStamp& InStamp, const float InSign);
+	const FInfluenceKernel& FindOrBuildKernel(const int32 InRadius);
+	FORCEINLINE int32 GetCellIndex(const int32 X, const int32 Y) const { return (X + MaxManhattanDistance) * Pitch + (Y + MaxManhattanDistance); };
+
+	int32 MaxManhattanDistance;
+	int32 Pitch;
+	uint32 Version;
+	TArray<float> Layers[(int32)EXkHexagonInfluenceLayer::Num];
+	TSparseArray<FXkHexagonInfluenceStamp> Stamps;
+	TMap<int32, FInfluenceKernel> Kernels;
+	TSharedPtr<const FXkHexagonInfluenceSnapshot, ESPMode::ThreadSafe> CachedSnapshot;
+};
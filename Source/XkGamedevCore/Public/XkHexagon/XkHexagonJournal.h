@@ -0,0 +1,100 @@
+// Copyright ©ICEPRINCE. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Hexagon Node Field
+ * Which part of a node was touched, consumers skip the work a change does not concern.
+ */
+enum class EXkHexagonNodeField : uint8
+{
+	None = 0,
+	Type = 1 << 0,
+	Height = 1 << 1,
+	Splat = 1 << 2,
+	CustomData = 1 << 3,
+	Position = 1 << 4, // horizontal position or radius
+	Added = 1 << 5,
+	Removed = 1 << 6,
+	All = 0xFF,
+};
+ENUM_CLASS_FLAGS(EXkHexagonNodeField);
+
+
+struct FXkHexagonNodeChange
+{
+	FXkHexagonNodeChange() : Coord(FIntVector::ZeroValue), Fields(EXkHexagonNodeField::None) {};
+	FXkHexagonNodeChange(const FIntVector& InCoord, const EXkHexagonNodeField InFields) : Coord(InCoord), Fields(InFields) {};
+
+	FIntVector Coord;
+	EXkHexagonNodeField Fields;
+};
+
+
+/**
+ * Hexagonal World Change Journal
+ * Per frame list of dirty cells of the node table. Every consumer (instance upload, canvas redraw,
+ * pathfinding caches, labels) subscribes once and keeps a cursor, then applies only the changes
+ * made since its last Consume. Game thread only.
+ */
+class XKGAMEDEVCORE_API FXkHexagonalWorldChangeJournal
+{
+public:
+	FXkHexagonalWorldChangeJournal();
+
+	/**
+	* @brief Record a node change into the current frame, repeated changes of one coord are merged
+	*/
+	void Record(const FIntVector& InCoord, const EXkHexagonNodeField InFields);
+
+	/**
+	* @brief Record a change of the whole table, subscribers would rebuild from scratch
+	*/
+	void RecordReset();
+
+	/**
+	* @brief Close the current frame, frames every subscriber has consumed are dropped
+	*/
+	void EndFrame();
+
+	/**
+	* @return Handle of a new cursor, starts at the current frame
+	*/
+	int32 Subscribe();
+
+	void Unsubscribe(const int32 InHandle);
+
+	/**
+	* @brief Collect the changes of every closed frame since the last call, merged per coord
+	* @param OutChanges Changed nodes, empty when nothing changed
+	* @return False when the subscriber must rebuild from scratch, i.e. the table was reset or the subscriber fell behind MaxFrames
+	*/
+	bool Consume(const int32 InHandle, TArray<FXkHexagonNodeChange>& OutChanges);
+
+	uint64 GetFrameSequence() const { return NextSequence; };
+
+	/* Frames kept for slow subscribers before they are forced to rebuild.*/
+	static constexpr int32 MaxFrames = 64;
+
+private:
+	struct FJournalFrame
+	{
+		bool bReset = false;
+		TArray<FXkHexagonNodeChange> Changes;
+	};
+
+	void TrimFrames();
+
+	// Frames[0] has sequence FirstSequence, the frame being recorded is not in Frames yet.
+	TArray<FJournalFrame> Frames;
+	uint64 FirstSequence;
+	uint64 NextSequence;
+
+	FJournalFrame PendingFrame;
+	TMap<FIntVector, int32> PendingIndices;
+
+	// Next sequence to consume for every subscriber.
+	TSparseArray<uint64> Cursors;
+};
@@ -2,18 +2,16 @@
 
 #pragma once
 
-// STL
-#include <random>
-
 #include "CoreMinimal.h"
+#include "XkHexagonJournal.h"
 #include "XkHexagonPathfinding.generated.h"
 
 // 1024 x 1024
 #define	MAX_HEXAGON_NODE_COUNT 1048576
 
-template<typename T0, typename T1>
-extern void BuildHexagon(TArray<T0>& OutBaseVertices, TArray<T1>& OutBaseIndices, TArray<T0>& OutEdgeVertices, TArray<T1>& OutEdgeIndices,
-	float Radius, float Height, float BaseInnerGap, float BaseOuterGap, float EdgeInnerGap, float EdgeOuterGap);
+// 32 x 32 cube coords (X, Y) per streaming chunk
+#define HEXAGON_CHUNK_SHIFT 5
+#define HEXAGON_CHUNK_SIZE (1 << HEXAGON_CHUNK_SHIFT)
 
 static float Sin30 = FMath::Sin(UE_DOUBLE_PI / (180.0) * 30.0);
 static float Cos30 = FMath::Cos(UE_DOUBLE_PI / (180.0) * 30.0);
@@ -25,28 +23,9 @@ static float XkCos45 = 0.70710678118654752440084436210485;
 static float XkCos60 = 0.5;
 static float XkCos30xCos45x2 = 1.224744871391589049098642037353;
 
-static int RandRangeIntMT (float seed, int min, int max)
-{
-	std::mt19937 gen(seed); // Initialize Mersenne Twister algorithm generator with seed value
-	std::uniform_int_distribution<> dis(min, max); // Define a uniform distribution from min to max
-	return dis(gen); // Generate random number
-};
-
-static float RandRangeFloatMT(float seed, float min, float max)
-{
-	std::mt19937 gen(seed); // Initialize Mersenne Twister algorithm generator with seed value
-	std::uniform_real_distribution<> dis(min, max); // Define a uniform distribution from min to max
-	return dis(gen); // Generate random number
-};
-
-static bool RandRangeBoolMT(float seed)
-{
-	std::mt19937 gen(seed); // Initialize Mersenne Twister algorithm generator with seed value
-	std::uniform_int_distribution<> dis(0, 1); // Define a uniform distribution from 0 to 1
-	return dis(gen) == 1; // Generate random number
-};
-
 class AXkHexagonActor;
+class FXkHexagonInfluenceMap;
+struct FXkHexagonalWorldSnapshot;
 
 USTRUCT(BlueprintType, Blueprintable)
 struct FXkPathCostValue
@@ -144,7 +123,7 @@ struct FXkHexagonSplat
 {
 	GENERATED_BODY()
 
-	FXkHexagonSplat() : TargetType(EXkHexagonType::Unavailable), Height(100.0f), Splats() {};
+	FXkHexagonSplat() : TargetType(EXkHexagonType::Unavailable), Height(100.0f), NoiseHeight(0.0f), Splats() {};
 public:
 	UPROPERTY(EditAnywhere, Category = "HexagonSplat [KEVINTSUIXUGAMEDEV]")
 	EXkHexagonType TargetType;
@@ -152,6 +131,10 @@ public:
 	UPROPERTY(EditAnywhere, Category = "HexagonSplat [KEVINTSUIXUGAMEDEV]")
 	float Height;
 
+	/* Height added at the full FBM terrain noise, see HeightNoiseSize of the world. */
+	UPROPERTY(EditAnywhere, Category = "HexagonSplat [KEVINTSUIXUGAMEDEV]")
+	float NoiseHeight;
+
 	UPROPERTY(EditAnywhere, Category = "HexagonSplat [KEVINTSUIXUGAMEDEV]")
 	TArray<uint8> Splats;
 };
@@ -243,6 +226,50 @@ struct XKGAMEDEVCORE_API FXkHexagonalWorldNodeTable
 public:
 	UPROPERTY(EditAnywhere, Category = "HexagonTable [KEVINTSUIXUGAMEDEV]")
 	TMap<FIntVector, FXkHexagonNode> Nodes;
+
+	/**
+	* @brief Record a node change, only the snapshot page holding it is copied by the next PublishSnapshot
+	* @param InCoord The coord of the added, modified or removed node
+	* @param InFields The fields of the node which were changed, forwarded to the change journal
+	*/
+	void MarkNodeDirty(const FIntVector& InCoord, const EXkHexagonNodeField InFields = EXkHexagonNodeField::All);
+
+	/**
+	* @brief Record a change to the whole table, e.g. after regenerating the world
+	*/
+	void MarkAllNodesDirty();
+
+	/**
+	* @brief Publish the pending changes as a new immutable snapshot and close the journal frame, should be called once per frame on game thread
+	* @return The latest snapshot, unchanged pages are shared with the previous one
+	*/
+	TSharedRef<const FXkHexagonalWorldSnapshot, ESPMode::ThreadSafe> PublishSnapshot();
+
+	uint32 GetSnapshotVersion() const { return SnapshotVersion; };
+
+	FXkHexagonalWorldChangeJournal& GetChangeJournal() { return ChangeJournal; };
+
+	static FIntPoint GetChunkKey(const FIntVector& InCoord) { return FIntPoint(InCoord.X >> HEXAGON_CHUNK_SHIFT, InCoord.Y >> HEXAGON_CHUNK_SHIFT); };
+
+	/**
+	* @brief Whether the chunk holding a coord is resident, a missing node of a resident chunk does not exist while
+	* a missing node of an unloaded chunk is simply not streamed in yet
+	*/
+	bool IsCoordLoaded(const FIntVector& InCoord) const { return !bStreamingChunks || LoadedChunks.Contains(GetChunkKey(InCoord)); };
+
+	void SetStreamingChunks(const bool bInStreamingChunks) { bStreamingChunks = bInStreamingChunks; LoadedChunks.Empty(); };
+
+	void SetChunkLoaded(const FIntPoint& InChunkKey, const bool bInLoaded) { if (bInLoaded) { LoadedChunks.Add(InChunkKey); } else { LoadedChunks.Remove(InChunkKey); } };
+
+private:
+	bool bStreamingChunks = false;
+	TSet<FIntPoint> LoadedChunks;
+
+	FXkHexagonalWorldChangeJournal ChangeJournal;
+	TMap<FIntPoint, TArray<FIntVector>> DirtyPages;
+	bool bAllPagesDirty = true;
+	uint32 SnapshotVersion = 0;
+	TSharedPtr<const FXkHexagonalWorldSnapshot, ESPMode::ThreadSafe> LatestSnapshot;
 };
 
 
@@ -263,9 +290,16 @@ public:
 	void Init(FXkHexagonalWorldNodeTable* InNodeTable);
 	void Reinit();
 	void Blocking(const TArray<FIntVector>& Input);
+	/**
+	* @brief Let the danger layer of an influence map push paths away, the danger of a coord times InDangerCost is added to its cost
+	* @param InInfluenceMap Influence map read while searching, nullptr or zero InDangerCost ignores the influence
+	*/
+	void Influencing(const FXkHexagonInfluenceMap* InInfluenceMap, const float InDangerCost);
 	bool Pathfinding(const FIntVector& StartingPoint, const FIntVector& TargetPoint, int32 MaxStep = 9999);
 	TArray<FIntVector> Backtracking(const int32 MaxStep = 9999) const;
 	TArray<FIntVector> SearchArea() const;
+	/* Whether the last search ran into a chunk which is not streamed in, the result is not final then.*/
+	bool HasReachedUnloadedArea() const { return bReachedUnloadedArea; };
 public:
 	static FXkPathCostValue CalcPathCostValue(const FIntVector& StartingPoint, const FIntVector& ConsideredPoint, const FIntVector& TargetPoint, int32 Offset = 0);
 	static int32 CalcManhattanDistance(const FIntVector& PointA, const FIntVector& PointB);
@@ -302,6 +336,11 @@ protected:
 	FIntVector TheTargetPoint; // target point
 
 	FXkHexagonalWorldNodeTable* HexagonalWorldTable;
+
+	const FXkHexagonInfluenceMap* InfluenceMap = nullptr;
+	float DangerCost = 0.0f;
+
+	bool bReachedUnloadedArea = false;
 };
 
 
@@ -0,0 +1,82 @@
+// Copyright ©ICEPRINCE. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Random streams, one per independent decision made for a hexagon.
+#define HEXAGON_RANDOM_STREAM_SPLAT 1
+#define HEXAGON_RANDOM_STREAM_HEIGHT 2
+#define HEXAGON_RANDOM_STREAM_POSITION 3
+
+/**
+ * Hexagon Random
+ * Stateless counter based random keyed by (world seed, coord, stream). Every value is a pure
+ * integer hash of its key, so results are bit identical across platforms, threads and call order.
+ */
+struct XKGAMEDEVCORE_API FXkHexagonRandom
+{
+	/**
+	* @brief 32 bit integer finalizer (lowbias32), only constant shifts and multiplies so it maps onto SIMD lanes
+	*/
+	static FORCEINLINE uint32 Hash(uint32 Value)
+	{
+		Value ^= Value >> 16;
+		Value *= 0x7feb352dU;
+		Value ^= Value >> 15;
+		Value *= 0x846ca68bU;
+		Value ^= Value >> 16;
+		return Value;
+	};
+
+	static FORCEINLINE uint32 Random(const uint32 InSeed, const FIntVector& InCoord, const uint32 InStream)
+	{
+		uint32 Value = Hash(InSeed ^ Hash(InStream));
+		Value = Hash(Value ^ (uint32)InCoord.X);
+		Value = Hash(Value ^ (uint32)InCoord.Y);
+		Value = Hash(Value ^ (uint32)InCoord.Z);
+		return Value;
+	};
+
+	/* Uniform in [0, 1), 24 bits of the hash so the float is exact.*/
+	static FORCEINLINE float RandomFloat(const uint32 InSeed, const FIntVector& InCoord, const uint32 InStream)
+	{
+		return (float)(Random(InSeed, InCoord, InStream) >> 8) * (1.0f / 16777216.0f);
+	};
+
+	/* Uniform in [InMin, InMax], both inclusive.*/
+	static FORCEINLINE int32 RandRange(const uint32 InSeed, const FIntVector& InCoord, const uint32 InStream, const int32 InMin, const int32 InMax)
+	{
+		return MapRange(Random(InSeed, InCoord, InStream), InMin, InMax);
+	};
+
+	static FORCEINLINE float RandRange(const uint32 InSeed, const FIntVector& InCoord, const uint32 InStream, const float InMin, const float InMax)
+	{
+		return InMin + (InMax - InMin) * RandomFloat(InSeed, InCoord, InStream);
+	};
+
+	static FORCEINLINE bool RandBool(const uint32 InSeed, const FIntVector& InCoord, const uint32 InStream)
+	{
+		return (Random(InSeed, InCoord, InStream) >> 31) != 0;
+	};
+
+	/* Multiply shift into [InMin, InMax], no modulo bias worth noticing and no division.*/
+	static FORCEINLINE int32 MapRange(const uint32 InRandom, const int32 InMin, const int32 InMax)
+	{
+		if (InMax <= InMin)
+		{
+			return InMin;
+		}
+		const uint64 Range = (uint64)((int64)InMax - (int64)InMin + 1);
+		return (int32)((int64)InMin + (int64)(((uint64)InRandom * Range) >> 32));
+	};
+
+	/**
+	* @brief Random of many coords at once, four lanes per iteration, equal to Random for every coord
+	* @param InCoords Coords to hash
+	* @param OutValues Results, at least InNum long
+	*/
+	static void RandomBatch(const uint32 InSeed, const uint32 InStream, const FIntVector* InCoords, uint32* OutValues, const int32 InNum);
+
+	static void RandRangeBatch(const uint32 InSeed, const uint32 InStream, const FIntVector* InCoords, const int32 InMin, const int32 InMax, int32* OutValues, const int32 InNum);
+};
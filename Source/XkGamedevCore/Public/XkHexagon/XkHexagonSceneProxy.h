@@ -7,12 +7,55 @@
 #include "RenderResource.h"
 #include "UniformBuffer.h"
 #include "VertexFactory.h"
+#include "RHIUtilities.h"
+#include "Math/Float16.h"
 #include "XkHexagonComponents.h"
+#include "XkHexagonGeometry.h"
 
+// Instance slots of one snapshot page, every page draws from a block of its own
+#define HEXAGON_INSTANCE_BLOCK_SIZE (HEXAGON_SNAPSHOT_PAGE_SIZE * HEXAGON_SNAPSHOT_PAGE_SIZE)
+// Full edges, three sides, and no edges
+#define HEXAGON_EDGE_LOD_NUM 3
+// Colors one proxy can tell apart, palette indices are 8 bits
+#define HEXAGON_PALETTE_SIZE 256
+
+class FSceneView;
+struct FMeshBatch;
 class FXkHexagonalWorldVertexFactoryShaderParameters;
 class FXkHexagonalWorldVertexFactory;
 class FXkHexagonalWorldSceneProxy;
 
+/**
+ * Hexagon Instance
+ * Packed instance stream of the hexagonal world, decoded in XkVertexFactory.ush under HEXAGON_VERTEX.
+ * XY of the hexagon follow from the axial coord, colors are indices into the palette of the scene proxy.
+ */
+struct FXkHexagonInstance
+{
+	FXkHexagonInstance() : CoordX(0), CoordY(0), BaseColorIndex(0), EdgeColorIndex(0), Splatmap(0), Padding(0) {};
+
+	bool operator==(const FXkHexagonInstance& Other) const
+	{
+		return CoordX == Other.CoordX && CoordY == Other.CoordY
+			&& Height.Encoded == Other.Height.Encoded && Scale.Encoded == Other.Scale.Encoded
+			&& BaseColorIndex == Other.BaseColorIndex && EdgeColorIndex == Other.EdgeColorIndex && Splatmap == Other.Splatmap;
+	};
+	bool operator!=(const FXkHexagonInstance& Other) const { return !(*this == Other); };
+
+	// VET_Short4, the halfs are read as raw bits
+	int16 CoordX;
+	int16 CoordY;
+	FFloat16 Height;
+	FFloat16 Scale;
+	// VET_UByte4
+	uint8 BaseColorIndex;
+	uint8 EdgeColorIndex;
+	uint8 Splatmap;
+	uint8 Padding;
+};
+static_assert(sizeof(FXkHexagonInstance) == 12, "FXkHexagonInstance must match the vertex declaration");
+
+
 class FXkHexagonalWorldVertexFactory : public FVertexFactory
 {
 	DECLARE_VERTEX_FACTORY_TYPE(FXkHexagonalWorldVertexFactory);
@@ -37,15 +80,19 @@ public:
 
 	static bool ShouldCache(const FVertexFactoryShaderPermutationParameters& Parameters) { return true; }
 
-	void SetVertexBuffer(FVertexBuffer* InData0, FVertexBuffer* InData1, FVertexBuffer* InData2);
+	void SetVertexBuffer(FVertexBuffer* InData0, FVertexBuffer* InData1);
 
 	static bool ShouldCompilePermutation(const FVertexFactoryShaderPermutationParameters& Parameters);
 
 	static void ModifyCompilationEnvironment(const FVertexFactoryShaderPermutationParameters& Parameters, FShaderCompilerEnvironment& OutEnvironment);
 
 	FVertexBuffer* VertexPositionVertexBuffer;
-	FVertexBuffer* InstancePositionVertexBuffer;
-	FVertexBuffer* InstanceColorVertexBuffer;
+	FVertexBuffer* InstanceVertexBuffer;
+	// Palette of the instance color indices, and which index of the instance this factory draws with.
+	FReadBuffer* PaletteBuffer;
+	uint32 PaletteChannel;
+	// Distance between the centers of neighbour hexagons
+	float HexagonDistance;
 };
 
 
@@ -54,15 +101,6 @@ class FXkHexagonalWorldSceneProxy : public FPrimitiveSceneProxy
 	friend UXkHexagonalWorldComponent;
 	friend FXkHexagonalWorldVertexFactoryShaderParameters;
 	friend FXkHexagonalWorldVertexFactory;
-
-	struct FHexagonData
-	{
-		TArray<FVector4f> BaseVertices;
-		TArray<uint32> BaseIndices;
-
-		TArray<FVector4f> EdgeVertices;
-		TArray<uint32> EdgeIndices;
-	} HexagonData;
 public:
 	FXkHexagonalWorldSceneProxy(
 		const UXkHexagonalWorldComponent* InComponent, const FName ResourceName = NAME_None,
@@ -73,7 +111,7 @@ public:
 	typedef FXkHexagonalWorldSceneProxy Super;
 
 	//~ Begin FPrimitiveSceneProxy Interface
-	//virtual void DrawStaticElements(FStaticPrimitiveDrawInterface* PDI) override;
+	virtual void DrawStaticElements(FStaticPrimitiveDrawInterface* PDI) override;
 	virtual SIZE_T GetTypeHash() const override;
 	virtual uint32 GetMemoryFootprint(void) const override;
 	virtual uint32 GetAllocatedSize(void) const { return(FPrimitiveSceneProxy::GetAllocatedSize()); }
@@ -88,24 +126,131 @@ public:
 	//~ End FPrimitiveSceneProxy Interface
 
 	virtual void GenerateBuffers();
-	virtual void GenerateBuffers_Renderthread(FRHICommandListImmediate& RHICmdList, FHexagonData* InHexagonData);
-	virtual void UpdateInstanceBuffer(const int16 InFrameTag);
+	virtual void GenerateBuffers_Renderthread(FRHICommandListImmediate& RHICmdList);
+	/**
+	* @brief Bring the instance mirror up to the snapshot when a full sync is pending, then upload only the slots that changed
+	*/
+	virtual void UpdateInstanceBuffer();
+	/**
+	* @brief Apply every update the component sent since the last frame, called at the beginning of each frame on render thread
+	*/
+	virtual void DrainRenderUpdates();
 
 protected:
-	UXkHexagonalWorldComponent* OwnerComponent;
+	// The only way in from the component after construction, the proxy never reads UObject state.
+	FXkHexagonalWorldRenderChannelPtr RenderChannel;
+	FDelegateHandle BeginFrameHandle;
 	FXkHexagonalWorldVertexFactory* BaseVertexFactory;
 	FXkHexagonalWorldVertexFactory* EdgeVertexFactory;
 	FMaterialRenderProxy* BaseMaterialRenderProxy;
 	FMaterialRenderProxy* EdgeMaterialRenderProxy;
 	FMaterialRelevance MaterialRelevance;
+	bool bShowBaseMesh;
+	bool bShowEdgeMesh;
+	// Draw through cached mesh draw commands instead of GetDynamicMeshElements, see r.xk.HexagonStaticDraw
+	bool bStaticDraw;
+	// Slot range, visibility or instance buffers changed since the static meshes were cached
+	bool bStaticMeshesDirty;
+	// Edges are drawn per view with a LOD per chunk, see r.xk.HexagonEdgeLOD
+	bool bEdgeLOD;
+	// Chunks are drawn front to back per view, see r.xk.HexagonSortChunks
+	bool bSortChunks;
+
+	// Vertex and index buffers are shared by every proxy with the same sizes.
+	FXkHexagonGeometryPtr Geometry;
+	FVertexBuffer InstanceBuffer_GPU;
+	FReadBuffer PaletteBuffer_GPU;
 
-	FVertexBuffer VertexPositionBuffer_GPU;
-	FVertexBuffer InstancePositionBuffer_GPU;
-	FVertexBuffer InstanceBaseColorBuffer_GPU;
-	FVertexBuffer InstanceEdgeColorBuffer_GPU;
-	FIndexBuffer  BaseIndexBuffer_GPU;
-	FIndexBuffer  EdgeIndexBuffer_GPU;
+	FXkHexagonalWorldSnapshotPtr HexagonalWorldSnapshot;
+	FXkHexagonHighlightMap HexagonHighlights;
 
 private:
-	TArray<FIntVector> VisibleNodes;
+	/* Instances of one snapshot page, culled together.*/
+	struct FInstanceChunk
+	{
+		FIntPoint PageKey = FIntPoint::ZeroValue;
+		// Slots in use from the first slot of the block, a free block has none.
+		int32 Num = 0;
+		// Local space, the shader applies the primitive transform.
+		FBox Bounds = FBox(ForceInit);
+		// Largest instance scale, the edge LOD is picked for the biggest hexagon of the chunk.
+		float MaxScale = 0.0f;
+		// A slot shows a highlighted edge color, the half ring of edge LOD1 would show it on 3 sides only.
+		bool bEdgeHighlighted = false;
+		// Bounds, scale and highlighted edges are gathered again.
+		bool bBoundsDirty = false;
+	};
+
+	struct FInstanceRun
+	{
+		FInstanceRun(const int32 InFirstSlot, const int32 InSlotNum, const int32 InEdgeLOD = 0) : FirstSlot(InFirstSlot), SlotNum(InSlotNum), EdgeLOD(InEdgeLOD) {};
+
+		int32 FirstSlot;
+		int32 SlotNum;
+		int32 EdgeLOD;
+	};
+
+	/* Runs of instances in the chunks the view sees, every chunk without a view. Adjacent full blocks of the same edge LOD are merged,
+	 * the chunks are ordered front to back when sorted.*/
+	void GetInstanceRuns(const FSceneView* InView, TArray<FInstanceRun, TInlineAllocator<64>>& OutRuns) const;
+	/* Edge LOD of the chunk from the projected size of its hexagons nearest to the view.*/
+	int32 GetEdgeLOD(const FSceneView& InView, const FInstanceChunk& InChunk, const FBox& InWorldBounds) const;
+	/* Edge LOD1 is only kept where every neighbour hexagon draws its ring, the other chunks draw the full ring.*/
+	bool CanUseHalfEdgeRing(const FInstanceChunk& InChunk, const TArray<int32, TInlineAllocator<256>>& InBlockEdgeLODs) const;
+	/* Base or edge mesh with one element per run.*/
+	void SetupHexagonMesh(const bool bEdge, const int32 InEdgeLOD, const TArray<FInstanceRun, TInlineAllocator<64>>& InRuns, FMeshBatch& OutMesh) const;
+
+	/* Write the node into its slot, a new node takes the slot after the last one of its chunk.*/
+	void SetInstance(const FXkHexagonNode& InNode);
+	/* Free the slot of the coord, the last slot of the chunk moves into it to keep the chunk compact.*/
+	void RemoveInstance(const FIntVector& InCoord);
+	int32 AllocateInstanceBlock(const FIntPoint& InPageKey);
+	void UpdateInstanceChunkBounds();
+	void SetInstanceColors(const int32 InSlot);
+	/* Recolor the coords whose shown highlight changed, their slots are uploaded alone.*/
+	void ApplyHighlightChanges(const TArray<FXkHexagonHighlightChange>& InChanges);
+	/* Index of the color in the palette, a full palette is rebuilt from the colors in use before the nearest color is given.*/
+	uint8 FindPaletteIndex(const FVector4f& InColor);
+	/* Keep only the colors of the drawn highlights, every slot is colored again.*/
+	void RebuildPalette();
+	/* World space center and scale of the slot, as XkVertexFactory.ush decodes them.*/
+	FVector4f GetInstancePosition(const int32 InSlot) const;
+	/* Diff every page of the snapshot against the mirrored pages, when the journal could not tell the changes.*/
+	void SyncInstanceSnapshot();
+	/* Apply the journal changes of one update, only the changed nodes are looked up in the snapshot.*/
+	void ApplyNodeChanges(const TArray<FXkHexagonNodeChange>& InChanges);
+	/* Grow the instance buffers to hold the instances, true when they were created again and hold nothing.*/
+	bool ReserveInstanceBuffers(const int32 InInstanceNum);
+	void UploadDirtyInstances();
+	void UploadInstances(const int32 InFirstSlot, const int32 InSlotNum);
+	void UploadPalette();
+
+	// Pages the mirror was last synced to, unchanged pages are the same shared pointers.
+	TMap<FIntPoint, FXkHexagonalWorldSnapshotPagePtr> MirroredPages;
+	// The next UpdateInstanceBuffer diffs every page, set for the first snapshot and when the journal was reset.
+	bool bInstanceSyncPending;
+
+	// CPU mirror of the instance stream, one slot per drawn node in the block of its chunk.
+	TArray<FXkHexagonInstance> Instances;
+	TArray<FIntVector> SlotCoords;
+	TMap<FIntVector, int32> CoordSlots;
+	TArray<int32> DirtySlots;
+
+	// Chunks by block, and the block of every page with drawn nodes.
+	TArray<FInstanceChunk> InstanceChunks;
+	TMap<FIntPoint, int32> PageBlocks;
+	TArray<int32> FreeBlocks;
+	int32 InstanceNum;
+
+	// Highlight colors by index, index 0 is the white of nodes without highlight.
+	TArray<FVector4f> Palette;
+	bool bPaletteDirty;
+	bool bPaletteRebuilding;
+	// Counts the rebuilds, a slot colored during a rebuild keeps the indices of the rebuild.
+	uint32 PaletteRebuildNum;
+	float HexagonDistance;
+
+	// Instances the GPU buffers have room for, and the bytes of it in use.
+	int32 InstanceCapacity;
+	int64 InstanceBufferUsedBytes;
 };
\ No newline at end of file
@@ -0,0 +1,75 @@
+// Copyright ©ICEPRINCE. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "XkHexagonPathfinding.h"
+
+// 16 x 16 cube coords (X, Y) per snapshot page
+#define HEXAGON_SNAPSHOT_PAGE_SHIFT 4
+#define HEXAGON_SNAPSHOT_PAGE_SIZE (1 << HEXAGON_SNAPSHOT_PAGE_SHIFT)
+#define HEXAGON_SNAPSHOT_PAGE_MASK (HEXAGON_SNAPSHOT_PAGE_SIZE - 1)
+
+
+/**
+ * Hexagonal World Snapshot Page
+ * Immutable once published, shared by every snapshot in which it did not change.
+ */
+struct XKGAMEDEVCORE_API FXkHexagonalWorldSnapshotPage
+{
+	FXkHexagonalWorldSnapshotPage();
+
+	const FXkHexagonNode* Find(const FIntVector& InCoord) const;
+
+	void Add(const FXkHexagonNode& InNode);
+
+	static FIntPoint GetPageKey(const FIntVector& InCoord)
+	{
+		return FIntPoint(InCoord.X >> HEXAGON_SNAPSHOT_PAGE_SHIFT, InCoord.Y >> HEXAGON_SNAPSHOT_PAGE_SHIFT);
+	};
+
+	static int32 GetSlotIndex(const FIntVector& InCoord)
+	{
+		return (InCoord.X & HEXAGON_SNAPSHOT_PAGE_MASK) * HEXAGON_SNAPSHOT_PAGE_SIZE + (InCoord.Y & HEXAGON_SNAPSHOT_PAGE_MASK);
+	};
+
+	/* Index into Nodes for every cell of the page, INDEX_NONE when there is no node.*/
+	int16 Slots[HEXAGON_SNAPSHOT_PAGE_SIZE * HEXAGON_SNAPSHOT_PAGE_SIZE];
+
+	TArray<FXkHexagonNode> Nodes;
+};
+
+typedef TSharedPtr<const FXkHexagonalWorldSnapshotPage, ESPMode::ThreadSafe> FXkHexagonalWorldSnapshotPagePtr;
+
+
+/**
+ * Hexagonal World Snapshot
+ * Versioned, immutable copy of the node table. The game thread publishes one per frame,
+ * the render thread, pathfinding workers and the save system hold it without locks.
+ */
+struct XKGAMEDEVCORE_API FXkHexagonalWorldSnapshot
+{
+	FXkHexagonalWorldSnapshot() : Version(0), NodeNum(0) {};
+
+	const FXkHexagonNode* Find(const FIntVector& InCoord) const;
+
+	int32 Num() const { return NodeNum; };
+
+	template<typename FuncType>
+	void ForEachNode(FuncType&& Func) const
+	{
+		for (const TPair<FIntPoint, FXkHexagonalWorldSnapshotPagePtr>& PagePair : Pages)
+		{
+			for (const FXkHexagonNode& Node : PagePair.Value->Nodes)
+			{
+				Func(Node);
+			}
+		}
+	};
+
+	uint32 Version;
+	int32 NodeNum;
+	TMap<FIntPoint, FXkHexagonalWorldSnapshotPagePtr> Pages;
+};
+
+typedef TSharedPtr<const FXkHexagonalWorldSnapshot, ESPMode::ThreadSafe> FXkHexagonalWorldSnapshotPtr;
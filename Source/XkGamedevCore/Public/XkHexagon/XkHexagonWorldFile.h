@@ -0,0 +1,113 @@
+// Copyright ©ICEPRINCE. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "XkHexagonPathfinding.h"
+#include "XkHexagonGenerator.h"
+
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+// 'XHEX'
+#define HEXAGON_WORLD_FILE_MAGIC 0x58454858
+#define HEXAGON_WORLD_FILE_VERSION 1
+#define HEXAGON_WORLD_FILE_EXTENSION TEXT("xkhex")
+// Cooked worlds live in this directory under the project content dir. It holds no assets, so packaged builds only get it when
+// the project stages it as loose files, mapped files cannot come from a pak:
+// [/Script/UnrealEd.ProjectPackagingSettings]
+// +DirectoriesToAlwaysStageAsNonUFS=(Path="XkHexagonalWorlds")
+#define HEXAGON_WORLD_FILE_DIRECTORY TEXT("XkHexagonalWorlds")
+
+/**
+ * Hexagonal World File Header
+ * Followed by dense per cell arrays, cell of cube coord (X, Y) is (X + R) * Pitch + (Y + R).
+ * A cell whose type is zero holds no node. Every array starts 16 bytes aligned.
+ */
+struct FXkHexagonalWorldFileHeader
+{
+	uint32 Magic;
+	uint32 Version;
+	int32 MaxManhattanDistance;
+	int32 Pitch;
+	int32 NodeNum;
+	float Radius;
+	float GapWidth;
+	uint32 Reserved;
+	uint64 TypeOffset; // uint8 per cell
+	uint64 SplatOffset; // uint8 per cell
+	uint64 PositionOffset; // FVector4f per cell
+	uint64 CustomDataOffset; // FVector4f per cell
+};
+static_assert(sizeof(FXkHexagonalWorldFileHeader) == 64, "FXkHexagonalWorldFileHeader layout is part of the file format.");
+
+
+/**
+ * Hexagonal World File
+ * Cooked binary copy of the node table, memory mapped on load so the dense arrays are
+ * read in place instead of re-running the procedural generation.
+ */
+class XKGAMEDEVCORE_API FXkHexagonalWorldFile
+{
+public:
+	FXkHexagonalWorldFile();
+	~FXkHexagonalWorldFile();
+
+	/**
+	* @brief Write the node table into a world file
+	* @param InFilename Full path of the file
+	* @param InNodes The node table
+	* @param InRadius Hexagon radius the table was generated with
+	* @param InGapWidth Hexagon gap width the table was generated with
+	*/
+	static bool Save(const FString& InFilename, const TMap<FIntVector, FXkHexagonNode>& InNodes, const float InRadius, const float InGapWidth);
+
+	/**
+	* @brief Write a generated grid into a world file, the grid has the layout of the file so the arrays are copied as they are
+	*/
+	static bool Save(const FString& InFilename, const FXkHexagonalWorldGrid& InGrid);
+
+	/**
+	* @brief Memory map a world file, falls back to reading it into memory when the platform could not map it
+	* @return False when the file is missing, truncated or of another version
+	*/
+	bool Open(const FString& InFilename);
+
+	void Close();
+
+	bool IsOpen() const { return Data != nullptr; };
+
+	const FXkHexagonalWorldFileHeader& GetHeader() const { check(IsOpen()); return *reinterpret_cast<const FXkHexagonalWorldFileHeader*>(Data); };
+
+	/**
+	* @return Cell index into the dense arrays, INDEX_NONE when the coord is outside the grid
+	*/
+	int32 GetCellIndex(const FIntVector& InCoord) const;
+
+	const uint8* GetTypes() const { return Data + GetHeader().TypeOffset; };
+	const uint8* GetSplats() const { return Data + GetHeader().SplatOffset; };
+	const FVector4f* GetPositions() const { return reinterpret_cast<const FVector4f*>(Data + GetHeader().PositionOffset); };
+	const FVector4f* GetCustomData() const { return reinterpret_cast<const FVector4f*>(Data + GetHeader().CustomDataOffset); };
+
+	bool GetNode(const FIntVector& InCoord, FXkHexagonNode& OutNode) const;
+
+	/**
+	* @brief Expand the dense arrays into a node table, the only copy made on load
+	*/
+	void FillNodes(TMap<FIntVector, FXkHexagonNode>& OutNodes) const;
+
+	/**
+	* @brief Copy the dense arrays into a grid and compact its node cells, GeneratedSettings is left to the caller
+	*/
+	void FillGrid(FXkHexagonalWorldGrid& OutGrid) const;
+
+private:
+	bool Validate() const;
+	FXkHexagonNode MakeNode(const int32 InCellIndex, const FIntVector& InCoord) const;
+
+	TUniquePtr<IMappedFileHandle> MappedHandle;
+	TUniquePtr<IMappedFileRegion> MappedRegion;
+	TArray<uint8> LoadedData;
+	const uint8* Data;
+	int64 DataSize;
+};
@@ -0,0 +1,64 @@
+// Copyright ©ICEPRINCE. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Noise FBM
+ * CPU mirror of FractalBrownianMotion in Shaders/Private/XkNoiseFBM.ush, same functions and same float
+ * operation order. Every scalar function runs the 4 lane path, so scalar and batch results are identical.
+ * The hash is integer math, so RandomNoise1/2 and FBMSimulate of integer coords match the shader bit for bit.
+ * Other coords differ by the GPU fusing mul and add, within 1e-5, see XkNoiseFBMTests.cpp.
+ */
+struct XKGAMEDEVCORE_API FXkNoiseFBM
+{
+	// Same as OCTAVES of the shader.
+	static constexpr int32 Octaves = 6;
+
+	static float RandomNoise1(const FVector2f& InST);
+
+	/* Hash of integer coords, the fraction is truncated like the shader int2(st).*/
+	static float RandomNoise2(const FVector2f& InST);
+
+	static float FbmRandom(const FVector2f& InST) { return RandomNoise2(InST); };
+
+	static float FbmNoise(const FVector2f& InST);
+
+	static float FBMSimulate(const FVector2f& InST);
+
+	static float RemapValue(const float InInput, const float InInputMin, const float InInputMax, const float InOutputMin, const float InOutputMax)
+	{
+		return (InInput - InInputMin) / (InInputMax - InInputMin) * (InOutputMax - InOutputMin) + InOutputMin;
+	};
+
+	/* OutputFBM(st).x of the shader, the other channels are copies of it.*/
+	static float OutputFBM(const FVector2f& InST);
+
+	static float OutputFBM(const FVector3f& InWorldPosition, const float InSize);
+
+	/**
+	* @brief Zero or one mask of the world position, the variant the materials use
+	* @param InRandom Offset added to the world position
+	* @param InSize World size of one noise cell
+	* @param InLevel Noise value mapped to one before rounding
+	*/
+	static float OutputFBM(const FVector3f& InWorldPosition, const FVector3f& InRandom, const float InSize, const float InLevel);
+
+	// Four samples per call, lane i of each input is sample i.
+	static VectorRegister4Float RandomNoise2(const VectorRegister4Float& InX, const VectorRegister4Float& InY);
+	static VectorRegister4Float FbmNoise(const VectorRegister4Float& InX, const VectorRegister4Float& InY);
+	static VectorRegister4Float FBMSimulate(VectorRegister4Float InX, VectorRegister4Float InY);
+
+	/**
+	* @brief FBMSimulate of many samples, two registers per iteration
+	* @param OutValues Results, at least InNum long
+	*/
+	static void FBMSimulateBatch(const FVector2f* InST, float* OutValues, const int32 InNum);
+
+	/**
+	* @brief OutputFBM(WorldPosition, Random, Size, Level) of many world positions, e.g. a row of generated hexagons
+	* @param OutValues Results, at least InNum long
+	*/
+	static void OutputFBMBatch(const FVector3f* InWorldPositions, const FVector3f& InRandom, const float InSize, const float InLevel, float* OutValues, const int32 InNum);
+};
@@ -64,17 +64,48 @@ public:
 	virtual void SetCanvasExtent(const FVector4f& Input) { CanvasExtent = Input; }
 
 	virtual bool IsBuffersValid() const;
+	/**
+	* @brief Create the instance buffers, the vertex and index buffers only when the mesh changed
+	*/
 	virtual void CreateBuffers(
-		const TArray<FVector4f> Vertices,
-		const TArray<uint32> Indices,
-		const TArray<FVector4f> Positions,
-		const TArray<FVector4f> Weights);
+		const TArray<FVector4f>& Vertices,
+		const TArray<uint32>& Indices,
+		const TArray<FVector4f>& Positions,
+		const TArray<FVector4f>& Weights);
 	virtual void UpdateBuffers(
 		const TArray<FVector4f> Positions,
 		const TArray<FVector4f> Weights);
 	virtual void DrawCanvas();
 
+	/**
+	* @brief Draw again only the canvas pixels the bounds and the filters reaching into them cover
+	* @param InDirtyBounds Bounds of the changed instances, in the same space as the instance positions
+	*/
+	virtual void DrawCanvas(const FBox2D& InDirtyBounds);
+
+	/**
+	* @return Pixel rect of the bounds grown by the filter ranges, clamped to the canvas
+	*/
+	FIntRect GetCanvasDirtyRect(const FBox2D& InDirtyBounds) const;
+
+	/**
+	* @return Bounds of a pixel rect, in the same space as the instance positions
+	*/
+	FBox2D GetCanvasRectBounds(const FIntRect& InRect) const;
+
+	/**
+	* @brief Widest reach of the height filter in pixels, a dirty rect draws the instances this far around it again
+	*/
+	int32 GetHeightFilterRange() const { return FMath::Max((int32)ConvolutionRangeX, HeightSuperResRange) * HeightSuperResScale; };
+
 private:
+	// Super resolution of the height filter inside the splat mask range, see XkRendererCS.usf
+	static constexpr int32 HeightSuperResRange = 2;
+	static constexpr int32 HeightSuperResScale = 4;
+
+	/* Draw the whole canvas when the rect is empty.*/
+	void DrawCanvasRect(const FIntRect& InDirtyRect);
+
 	/* Vertex buffer for hexagonal world nodes*/
 	FXkCanvasVertexBuffer VertexBuffer;
 	/* Index buffer for hexagonal world nodes*/
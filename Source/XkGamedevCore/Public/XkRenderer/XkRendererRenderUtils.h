@@ -148,7 +148,8 @@ extern void XKGAMEDEVCORE_API XkCanvasRendererDraw(FRDGBuilder& GraphBuilder,
 	FXkCanvasRenderVS::FParameters* InVSParameters,
 	FXkCanvasRenderPS::FParameters* InPSParameters,
 	FXkCanvasVertexBuffer* InVertexBuffer,
-	FXkCanvasIndexBuffer* InIndexBuffer);
+	FXkCanvasIndexBuffer* InIndexBuffer,
+	const FIntRect& InScissorRect = FIntRect());
 
 /**
  * Computer shader to filter the canvas render targets.
@@ -163,6 +164,7 @@ class XKGAMEDEVCORE_API FXkCanvasRenderCS : public FGlobalShader
 		SHADER_PARAMETER(FIntVector4, SuperResMask)  // #0 Low splat id #1 High splat id #3 SuperRes minimal value #4 SuperRes scale factor
 		SHADER_PARAMETER(FVector4f, Center) // @TODO: just computer the pixel area which changed by game logic
 		SHADER_PARAMETER(FVector4f, Extent)
+		SHADER_PARAMETER(FIntPoint, DispatchOffset) // First pixel of the dispatch, only the dirty rect of the canvas is filtered
 		SHADER_PARAMETER_RDG_TEXTURE(Texture2D, SourceTexture0)
 		SHADER_PARAMETER_RDG_TEXTURE(Texture2D, SourceTexture1)
 		SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture2D, TargetTexture)
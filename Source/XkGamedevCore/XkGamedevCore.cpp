@@ -8,6 +8,8 @@
 
 #define LOCTEXT_NAMESPACE "FXkGamedevCoreModule"
 
+DEFINE_LOG_CATEGORY(LogXkGamedevCore);
+
 void FXkGamedevCoreModule::StartupModule()
 {
 	FString ShaderDir = FPaths::Combine(IPluginManager::Get().FindPlugin(TEXT("XkGamedevKit"))->GetBaseDir(), TEXT("Shaders"));